@@ -20,206 +20,1255 @@
 
 #include "Ai.hpp"
 
+#include <algorithm>
+#include <climits>
 #include <iostream>
+#include <sstream>
 
+#include "Config.hpp"
 #include "Debug.hpp"
+#include "Profiler.hpp"
 #include "World.hpp"
 
+// The target of a move is the first base of its play-outs.
+static const int PlayOutTarget = 0;
+
+static double GetExpectedDamage(const double Soldiers, const int DefenceValue);
+static double GetPlayOutValue(const std::vector<AIPlayOutBase> &Bases, const int PlayerNum);
+static void StepPlayOut(std::vector<AIPlayOutBase> &Bases, const float Delta);
+
+// Support and Threat are filled in once all the candidates are known.
+void
+AICandidates::Add(const CommandType Type,
+                  const int SrcBase, const int TargetBase, const AIBaseState &Target,
+                  const double Efficiency, const double Damage)
+{
+  this->Type.push_back(Type);
+  this->SrcBase.push_back(SrcBase);
+  this->TargetBase.push_back(TargetBase);
+  this->TargetSoldiers.push_back((float) Target.Soldiers);
+  this->TargetSize.push_back((float) Target.Size);
+  this->Efficiency.push_back((float) Efficiency);
+  this->Damage.push_back((float) Damage);
+  this->Support.push_back(0.0f);
+  this->Threat.push_back(0.0f);
+}
+
+void
+AICandidates::Clear(void)
+{
+  Type.clear();
+  SrcBase.clear();
+  TargetBase.clear();
+  TargetSoldiers.clear();
+  TargetSize.clear();
+  Efficiency.clear();
+  Damage.clear();
+  Support.clear();
+  Threat.clear();
+  Score.clear();
+}
+
+// Sets up a plan from a saved game, to be carried out as if it had just
+// been made.
+void
+AIDriver::ChangePlan(const Command *Commands, const int NumCommands)
+{
+  WaitForPlan();
+
+  Plan.assign(Commands, Commands + NumCommands);
+  Planning = NumCommands > 0;
+}
+
+// Phase, from 0 up to 1, is how much of the first DecisionTime has passed
+// when the AI starts, so the AIs of a match do not all start their
+// decisions at the same time.  Nothing is decided before then.
 bool
-AIDriver::Create(Player *PlayerToControl)
+AIDriver::Create(Player *PlayerToControl,
+                 const AIConfig &Config,
+                 const double Phase, const unsigned int Seed)
 {
-  this->Ticks = 0.0;
+  this->Ticks = Config.DecisionTime * Phase;
+  this->Config = Config;
+  this->Rand.seed(Seed);
+  this->Planning = false;
+  this->Delayed = false;
+  this->PlanStep = 0;
+  this->PlanReady = true;
+  this->GameWorld = nullptr;
+  this->AIPool = nullptr;
   if(PlayerToControl == nullptr) { return false; }
   this->PlayerToControl = PlayerToControl;
+  this->PlayerNum = (int) PlayerToControl->GetID() - 1;
 
   return true;
 }
 
+// The plan waiting to be carried out, empty if there is none.
+const std::vector<Command> &
+AIDriver::GetPlan(void)
+{
+  WaitForPlan();
+
+  return Plan;
+}
+
+uint32_t
+AIDriver::GetRandState(void) const
+{
+  std::stringstream RandState;
+  unsigned long State;
+
+  RandState << Rand;
+  RandState >> State;
+
+  return (uint32_t) State;
+}
+
+// A plan made without a pool goes through its steps in step with the time
+// that has passed since it started, a slice every tick, and carrying it
+// out finishes whatever is left.
 void
-AIDriver::Tick(Game *MainGame, const double Delta, std::minstd_rand &Rand)
+AIDriver::Tick(Simulation *MainSimulation, const double Delta)
 {
   Ticks += Delta;
-  if(Ticks >= (double) AI_DECISION_TIME) {
-#if DEBUG_AI
-    std::cerr << "AI: Player: " << PlayerToControl->GetID() << " Tick." << std::endl;
-#endif /* DEBUG_AI */
 
-    CheckBases(MainGame, Rand);
+  if(AIPool == nullptr && Planning && !PlanReady) {
+    const int NumSteps = GetNumPlanSteps();
+
+    ContinuePlan(std::min((int) ((NumSteps * Ticks) / AI_PLAN_TIME), NumSteps));
+  }
+
+  if(Planning && (Ticks >= AI_PLAN_TIME || Ticks >= Config.DecisionTime) &&
+     !IsPlanLate(MainSimulation)) {
+    CarryOutPlan(MainSimulation);
+  }
+
+  // The next decision waits for a late plan to be carried out.
+  if(!Planning && Ticks >= Config.DecisionTime) {
+    StartPlan(MainSimulation);
     Ticks = 0.0;
   }
+
+  Delayed = false;
 }
 
 // Private Functions of AIDriver
+// Adds attack candidate I to the plan, unlinking its source first as
+// Base::AttackBase() will only attack from a base without a link.
+void
+AIDriver::AddAttack(const int I)
+{
+  const int SrcBase = Candidates.SrcBase[I];
+  const int TargetBase = Candidates.TargetBase[I];
+
+#if DEBUG_AI
+  std::cerr << "AI: Attacking base: " << TargetBase
+            << " from base: "         << SrcBase << std::endl;
+#endif /* DEBUG_AI  */
+
+  Pledged[TargetBase] += Candidates.Damage[I];
+
+  if(GetBaseState(SrcBase).TargetBase >= 0) {
+    AddCommand(CommandType::Unlink, SrcBase, -1);
+    GetChangedBaseState(SrcBase).TargetBase = -1;
+  }
+
+  AddCommand(CommandType::Attack, SrcBase, TargetBase);
+  GetChangedBaseState(SrcBase).AttackingBase = TargetBase;
+  GetChangedBaseState(TargetBase).IncomingAttacks++;
+}
+
+void
+AIDriver::AddCommand(const CommandType Type, const int SrcBase, const int TargetBase)
+{
+  Command NewCommand;
+
+  NewCommand.Type = Type;
+  NewCommand.PlayerNum = PlayerNum;
+  NewCommand.SrcBase = SrcBase;
+  NewCommand.TargetBase = TargetBase;
+
+  Plan.push_back(NewCommand);
+}
+
+// Adds the moves of a base the player holds against its neighbours:
+// colonizing free bases and attacking enemy ones, leaving out what the
+// base could not do, such as more colonies than its soldiers pay for.
+// A base with such neighbours is at the front and starts FrontQueue.  The
+// snapshot is read directly, as the plan has not changed any base yet.
+void
+AIDriver::AddFrontCandidates(const int PlayerBase)
+{
+  const AIBaseState &Source = (*Snapshot)[PlayerBase];
+  const bool CanAttack = Source.Soldiers > 10.0 && Source.AttackingBase < 0;
+  const size_t First = Candidates.GetSize();
+  const BaseNeighbour *Neighbours;
+  int NumNeighbours;
+  int NumColonies;
+  double EnemySoldiers = 0.0;
+  bool AtFront = false;
+
+  // Every colony costs 5 soldiers and needs 10 when it is made.
+  NumColonies = (Source.Soldiers >= 10.0) ? (int) ((Source.Soldiers - 10.0) / 5.0) + 1 : 0;
+
+  Neighbours = GameWorld->GetBase(PlayerBase)->GetNeighbours(NumNeighbours);
+
+  for(int I = 0; I < NumNeighbours; I++) {
+    const int TargetBase = Neighbours[I].NeighbourIndex;
+    const AIBaseState &Target = (*Snapshot)[TargetBase];
+    const int Distance = Neighbours[I].Distance;
+
+    if(Target.Owner == PlayerNum) { continue; }
+
+    AtFront = true;
+
+    if(Target.Owner < 0) {
+      if(NumColonies == 0) { continue; }
+
+      Candidates.Add(CommandType::Colonize, PlayerBase, TargetBase, Target,
+                     GetAttackEfficiency(Distance), 0.0);
+      NumColonies--;
+    } else {
+      EnemySoldiers += Target.Soldiers;
+      if(!CanAttack) { continue; }
+
+      Candidates.Add(CommandType::Attack, PlayerBase, TargetBase, Target,
+                     GetAttackEfficiency(Distance),
+                     GetExpectedDamage(Source.Soldiers,
+                                       Neighbours[I].NeighbourBase->GetDefenceValue()));
+    }
+  }
+
+  for(size_t I = First; I < Candidates.GetSize(); I++) {
+    Candidates.Threat[I] = (float) (EnemySoldiers / (Source.Soldiers + 1.0));
+  }
+
+  if(AtFront) {
+    FrontDistance[PlayerBase] = 0;
+    FrontQueue.push_back(PlayerBase);
+  } else {
+    FrontDistance[PlayerBase] = INT_MAX;
+  }
+}
+
+// Goes out from the front through the player's bases, counting how many
+// links each needs to reach it, and adds a link for each base behind the
+// front that is not linked nearer yet, to the closest of its neighbours
+// one step nearer.  Bases cut off from the front stay at INT_MAX.
 void
-AIDriver::CheckBases(Game *MainGame, std::minstd_rand &Rand)
+AIDriver::AddLinkCandidates(void)
 {
-  World *GameWorld;
+  size_t Next = 0;
+
+  while(Next < FrontQueue.size()) {
+    const int PlayerBase = FrontQueue[Next++];
+    const AIBaseState &Source = (*Snapshot)[PlayerBase];
+    const BaseNeighbour *Neighbours;
+    int NumNeighbours;
+    bool Linked;
+
+    // A link that already leads nearer is kept.  Otherwise, as the bases
+    // before this one in the queue are all as near or nearer, the first
+    // neighbour found nearer is the closest one a step nearer.
+    Linked = FrontDistance[PlayerBase] == 0 || Source.AttackingBase >= 0 ||
+             Source.IncomingAttacks > 0;
+    if(Source.TargetBase >= 0 && (*Snapshot)[Source.TargetBase].Owner == PlayerNum &&
+       FrontDistance[Source.TargetBase] < FrontDistance[PlayerBase]) {
+      Linked = true;
+    }
 
-  GameWorld = MainGame->GetWorld();
-  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
-    Base *PlayerBase = GameWorld->GetBase(I);
+    // So is a chain of links that already ends at the front, rather than
+    // moving it over a step at a time.
+    if(Source.TargetBase >= 0 && (*Snapshot)[Source.Front].Owner == PlayerNum &&
+       FrontDistance[Source.Front] == 0) {
+      Linked = true;
+    }
+
+    Neighbours = GameWorld->GetBase(PlayerBase)->GetNeighbours(NumNeighbours);
+
+    for(int I = 0; I < NumNeighbours; I++) {
+      const int NeighbourBase = Neighbours[I].NeighbourIndex;
 
-    if(PlayerBase->GetOwner() != nullptr) {
-      if(PlayerBase->GetOwner()->GetID() == PlayerToControl->GetID()) {
-        ManageBase(PlayerBase, MainGame, Rand);
+      if((*Snapshot)[NeighbourBase].Owner != PlayerNum) { continue; }
+
+      if(FrontDistance[NeighbourBase] == INT_MAX) {
+        FrontDistance[NeighbourBase] = FrontDistance[PlayerBase] + 1;
+        FrontQueue.push_back(NeighbourBase);
+      } else if(!Linked && FrontDistance[NeighbourBase] < FrontDistance[PlayerBase]) {
+        Candidates.Add(CommandType::Link, PlayerBase, NeighbourBase, (*Snapshot)[NeighbourBase],
+                       GetTransferEfficiency(Neighbours[I].Distance), 0.0);
+        Linked = true;
       }
     }
   }
 }
 
+// Adds a snapshot base to the play-outs of Move, once.
+void
+AIDriver::AddPlayOutBase(AIMove &Move, const int BaseNum)
+{
+  if(PlayOutIndex[BaseNum] >= 0) { return; }
+
+  PlayOutIndex[BaseNum] = (int) Move.Bases.size();
+  Move.Bases.push_back(BaseNum);
+}
+
+void
+AIDriver::BuildCandidates(void)
+{
+  const int NumBases = (int) Snapshot->size();
+
+  if((int) FrontDistance.size() != NumBases) {
+    FrontDistance.assign(NumBases, INT_MAX);
+    Pledged.assign(NumBases, 0.0f);
+    Ordered.assign(NumBases, 0);
+    MoveIndex.assign(NumBases, -1);
+    PlayOutIndex.assign(NumBases, -1);
+  }
+
+  OwnBases.clear();
+  for(int I = 0; I < NumBases; I++) {
+    if((*Snapshot)[I].Owner == PlayerNum) { OwnBases.push_back(I); }
+  }
+
+  Candidates.Clear();
+  FrontQueue.clear();
+  for(size_t I = 0; I < OwnBases.size(); I++) { AddFrontCandidates(OwnBases[I]); }
+  AddLinkCandidates();
+
+  SumSupport();
+  ScoreCandidates();
+}
+
+// Copies the bases a move's play-outs need from the snapshot: the target,
+// the bases around it and the bases around the attackers.  Links and
+// attacks that leave them are dropped.
 void
-AIDriver::CheckBasesToAttack(Base *PlayerBase, Game *MainGame, std::minstd_rand &Rand)
+AIDriver::BuildMove(AIMove &Move)
 {
-  World *GameWorld;
+  const double AIGrowthModifier = GameWorld->GetBaseTable()->GetAIGrowthModifier();
+  const BaseNeighbour *Neighbours;
+  int NumNeighbours;
+
+  Move.Bases.clear();
+  Move.Attackers.clear();
+  Move.Start.clear();
+
+  AddPlayOutBase(Move, Move.TargetBase); // At PlayOutTarget
 
-  GameWorld = MainGame->GetWorld();
+  Neighbours = GameWorld->GetBase(Move.TargetBase)->GetNeighbours(NumNeighbours);
+  for(int I = 0; I < NumNeighbours; I++) { AddPlayOutBase(Move, Neighbours[I].NeighbourIndex); }
 
-  for(int I = 0; I < GameWorld->GetBaseArraySize(); I++) {
-    Base *TargetBase = GameWorld->GetBaseFromArray(I);
+  for(size_t I = 0; I < Move.Candidates.size(); I++) {
+    const int SrcBase = Candidates.SrcBase[Move.Candidates[I]];
+
+    Neighbours = GameWorld->GetBase(SrcBase)->GetNeighbours(NumNeighbours);
+    for(int J = 0; J < NumNeighbours; J++) { AddPlayOutBase(Move, Neighbours[J].NeighbourIndex); }
+
+    Move.Attackers.push_back(PlayOutIndex[SrcBase]);
+  }
 
-    if(TargetBase->GetOwner() != nullptr) {
+  Move.Start.resize(Move.Bases.size());
+  for(size_t I = 0; I < Move.Bases.size(); I++) {
+    Base *SnapshotBase = GameWorld->GetBase(Move.Bases[I]);
+    const AIBaseState &State = (*Snapshot)[Move.Bases[I]];
+    AIPlayOutBase &PlayOutBase = Move.Start[I];
+
+    PlayOutBase.Soldiers = (float) State.Soldiers;
+    PlayOutBase.Growth = (float) State.Growth;
+    PlayOutBase.CaptureGrowth = (float) ((State.Size / 10.0) * AIGrowthModifier);
+    PlayOutBase.Owner = State.Owner;
+    PlayOutBase.TargetBase = (State.TargetBase >= 0) ? PlayOutIndex[State.TargetBase] : -1;
+    PlayOutBase.AttackingBase = (State.AttackingBase >= 0) ? PlayOutIndex[State.AttackingBase] : -1;
+    PlayOutBase.TransferRate = 0.0f;
+    PlayOutBase.AttackRate = 0.0f;
+    PlayOutBase.Roll = (float) State.Roll;
+
+    if(PlayOutBase.TargetBase >= 0) {
+      const int Distance = SnapshotBase->GetDistanceToBase(GameWorld->GetBase(State.TargetBase));
+
+      PlayOutBase.TransferRate = (float) GetTransferEfficiency(Distance);
+    }
+
+    if(PlayOutBase.AttackingBase >= 0) {
+      const int Distance = SnapshotBase->GetDistanceToBase(GameWorld->GetBase(State.AttackingBase));
+
+      PlayOutBase.AttackRate = (float) GetAttackEfficiency(Distance);
+    }
+  }
+
+  // The links from outside the play-outs bring what the supply graph has
+  // them carry once settled: the supply of a base less the flows of the
+  // links into it that are played out.
+  for(size_t I = 0; I < Move.Bases.size(); I++) {
+    Move.Start[I].Growth += (float) (*Snapshot)[Move.Bases[I]].Supply;
+  }
+
+  for(size_t I = 0; I < Move.Bases.size(); I++) {
+    const AIBaseState &State = (*Snapshot)[Move.Bases[I]];
+
+    if(Move.Start[I].TargetBase >= 0) {
+      Move.Start[Move.Start[I].TargetBase].Growth -= (float) (State.Growth + State.Supply);
+    }
+  }
+
+  for(size_t I = 0; I < Move.Bases.size(); I++) {
+    Move.Start[I].Growth = std::max(Move.Start[I].Growth, (float) (*Snapshot)[Move.Bases[I]].Growth);
+  }
+
+  for(size_t I = 0; I < Move.Bases.size(); I++) { PlayOutIndex[Move.Bases[I]] = -1; }
+
+  Move.TargetDefence = GameWorld->GetBase(Move.TargetBase)->GetDefenceValue();
+  Move.Seed = (uint32_t) Rand();
+  Move.Gain = 0.0;
+}
+
+// Carries the plan out through the bases, which turn down whatever the
+// match has made impossible since the snapshot.
+void
+AIDriver::CarryOutPlan(Simulation *MainSimulation)
+{
+  World *TargetWorld = MainSimulation->GetWorld();
+
+  WaitForPlan();
+
+  for(size_t I = 0; I < Plan.size(); I++) {
+    const Command &PlanCommand = Plan[I];
+    Base *SrcBase = TargetWorld->GetBase(PlanCommand.SrcBase);
+    Base *TargetBase = TargetWorld->GetBase(PlanCommand.TargetBase);
+
+    if(SrcBase->GetOwner() != PlayerToControl) { continue; }
+
+    switch(PlanCommand.Type) {
+    case CommandType::Attack:
+      MainSimulation->AttackBase(SrcBase, TargetBase);
+      break;
+    case CommandType::Colonize:
+      TargetBase->Colonize(PlayerToControl, SrcBase);
+      break;
+    case CommandType::Link:
+      SrcBase->ChangeTargetBase(TargetBase);
+      break;
+    case CommandType::Unlink:
+      SrcBase->ChangeTargetBase(nullptr);
+      break;
+    default:
+      abort();
+    }
+  }
+
+  Plan.clear();
+  Planning = false;
+}
+
+void
+AIDriver::CheckBasesToAttack(const int PlayerBase)
+{
+  for(size_t I = 0; I < NearByBases.size(); I++) {
+    const int TargetBase = NearByBases[I];
+    const AIBaseState &Target = GetBaseState(TargetBase);
+
+    if(Target.Owner >= 0) {
       unsigned int ChanceToAttack;
 
-      if(TargetBase->GetTargetBase() != nullptr) {
-        ChanceToAttack = AI_CHANCE_TO_ATTACK / 2;
+      if(Target.TargetBase >= 0) {
+        ChanceToAttack = Config.ChanceToAttack / 2;
       } else {
-        ChanceToAttack = AI_CHANCE_TO_ATTACK;
+        ChanceToAttack = Config.ChanceToAttack;
       }
 
-      if(TargetBase->GetOwner()->GetID() != PlayerToControl->GetID() &&
-         (Rand() % ChanceToAttack) == 0) {
+      if(Target.Owner != PlayerNum && (Rand() % ChanceToAttack) == 0) {
+        const AIBaseState &Source = GetBaseState(PlayerBase);
+
 #if DEBUG_AI
-        std::cerr << "AI: Attacking base: " << TargetBase->GetID()
-                  << " from base: "         << PlayerBase->GetID() << std::endl;
+        std::cerr << "AI: Attacking base: " << TargetBase
+                  << " from base: "         << PlayerBase << std::endl;
 #endif /* DEBUG_AI  */
 
-        PlayerBase->AttackBase(TargetBase, Rand);
-        LinkNearByBases(PlayerBase, MainGame);
+        AddCommand(CommandType::Attack, PlayerBase, TargetBase);
+
+        // As Base::AttackBase() will take it.
+        if(Source.Soldiers >= 10.0 && Source.TargetBase < 0) {
+          const int OldAttackingBase = Source.AttackingBase;
+
+          if(OldAttackingBase >= 0) { GetChangedBaseState(OldAttackingBase).IncomingAttacks--; }
+          GetChangedBaseState(PlayerBase).AttackingBase = TargetBase;
+          GetChangedBaseState(TargetBase).IncomingAttacks++;
+        }
+
+        LinkNearByBases(PlayerBase);
       }
     }
   }
 }
 
 void
-AIDriver::CheckBasesToColonize(Base *PlayerBase, Game *MainGame, std::minstd_rand &Rand)
+AIDriver::CheckBasesToColonize(const int PlayerBase)
 {
-  World *GameWorld;
+  int ClosestBase = -1;
+
+  if(GetBaseState(PlayerBase).TargetBase >= 0) { return; }
+
+  // Find the closest non-occupied base; the neighbours are closest first.
+  for(size_t I = 0; I < NearByBases.size(); I++) {
+    if(GetBaseState(NearByBases[I]).Owner < 0) {
+      ClosestBase = NearByBases[I];
+      break;
+    }
+  }
 
-  if(PlayerBase->GetTargetBase() != nullptr) { return; }
+  if(ClosestBase < 0) { return; }
 
-  GameWorld = MainGame->GetWorld();
+  for(size_t I = 0; I < NearByBases.size(); I++) {
+    if(Rand() % Config.ChanceToColonize) {
+#if DEBUG_AI
+      std::cerr << "AI: Colonize base: " << ClosestBase
+                << " from "              << PlayerBase << std::endl;
+#endif /* DEBUG_AI */
 
-  for(int I = 0; I < GameWorld->GetBaseArraySize(); I++) {
-    Base *ClosestBase = GameWorld->GetBaseFromArray(0);
+      AddCommand(CommandType::Colonize, PlayerBase, ClosestBase);
 
-    // Find the closest non-occupied base.
-    for(int J = 0; J < GameWorld->GetBaseArraySize(); J++) {
-      Base *TargetBase = GameWorld->GetBaseFromArray(J);
+      // As Base::Colonize() will take it.
+      if(GetBaseState(PlayerBase).Soldiers >= 10.0) {
+        AIBaseState &Target = GetChangedBaseState(ClosestBase);
 
-      if(TargetBase->GetOwner() == nullptr &&
-         PlayerBase->GetDistanceToBase(TargetBase) <
-         PlayerBase->GetDistanceToBase(ClosestBase)) {
-        ClosestBase = TargetBase;
+        Target.Owner = PlayerNum;
+        Target.Soldiers = 5.0;
+        GetChangedBaseState(PlayerBase).Soldiers -= 5.0;
       }
+
+      return;
     }
+  }
+}
+
+// Makes a move of each target the attack candidates are expected to do
+// best against, up to AI_ROLLOUT_MOVES of them.
+void
+AIDriver::ChooseMoves(void)
+{
+  const int NumCandidates = (int) Candidates.GetSize();
+  int NumMoves;
+
+  // The first attack candidate on each target stands for them all, as
+  // they share the target and their Support.
+  Ranking.clear();
+  for(int I = 0; I < NumCandidates; I++) {
+    if(Candidates.Type[I] != CommandType::Attack) { continue; }
+    if(MoveIndex[Candidates.TargetBase[I]] >= 0)   { continue; }
+
+    MoveIndex[Candidates.TargetBase[I]] = 0;
+    Ranking.push_back(I);
+  }
+
+  std::sort(Ranking.begin(), Ranking.end(), [this](const int A, const int B) {
+    const float OddsA = Candidates.Support[A] / (Candidates.TargetSoldiers[A] + 1.0f);
+    const float OddsB = Candidates.Support[B] / (Candidates.TargetSoldiers[B] + 1.0f);
+
+    if(OddsA != OddsB) { return OddsA > OddsB; }
+
+    return A < B;
+  });
+
+  for(size_t I = 0; I < Ranking.size(); I++) { MoveIndex[Candidates.TargetBase[Ranking[I]]] = -1; }
+
+  NumMoves = std::min((int) Ranking.size(), AI_ROLLOUT_MOVES);
+  Moves.resize(NumMoves);
+  for(int I = 0; I < NumMoves; I++) {
+    Moves[I].TargetBase = Candidates.TargetBase[Ranking[I]];
+    Moves[I].Candidates.clear();
+    MoveIndex[Moves[I].TargetBase] = I;
+  }
+
+  for(int I = 0; I < NumCandidates; I++) {
+    if(Candidates.Type[I] != CommandType::Attack) { continue; }
+    if(MoveIndex[Candidates.TargetBase[I]] < 0)    { continue; }
+
+    Moves[MoveIndex[Candidates.TargetBase[I]]].Candidates.push_back(I);
+  }
+
+  for(int I = 0; I < NumMoves; I++) {
+    MoveIndex[Moves[I].TargetBase] = -1;
+    BuildMove(Moves[I]);
+  }
+}
+
+// Runs the steps of a plan made without a pool up to EndStep, and
+// finishes it after the last.  A Dice step looks at a base, a Utility
+// plan builds its candidates in one step and takes them in the next, and
+// a MonteCarlo plan plays each move out in a step of its own.
+void
+AIDriver::ContinuePlan(const int EndStep)
+{
+  const int NumSteps = GetNumPlanSteps();
+
+  if(PlanStep >= EndStep) { return; }
+
+  PROFILE_ZONE(AI);
 
-    if(Rand() % AI_CHANCE_TO_COLONIZE) {
-      if(ClosestBase->GetOwner() == nullptr) {
 #if DEBUG_AI
-        std::cerr << "AI: Colonize base: " << ClosestBase->GetID()
-                  << " from "              << PlayerBase->GetID() << std::endl;
+  if(PlanStep == 0) {
+    std::cerr << "AI: Player: " << PlayerToControl->GetID() << " Tick." << std::endl;
+  }
 #endif /* DEBUG_AI */
 
-        ClosestBase->Colonize(PlayerToControl, PlayerBase);
+  switch(Config.Planner) {
+  case AIPlanner::Dice:
+    MakeDicePlan(PlanStep, EndStep);
+    break;
+  case AIPlanner::Utility:
+    if(PlanStep == 0)       { BuildCandidates(); }
+    if(EndStep == NumSteps) { TakeCandidates(); }
+    break;
+  case AIPlanner::MonteCarlo:
+    if(PlanStep == 0) {
+      BuildCandidates();
+      ChooseMoves();
+    }
 
-        return;
-      }
+    for(int I = std::max(PlanStep, 1); I < std::min(EndStep, NumSteps - 1); I++) {
+      if(I - 1 < (int) Moves.size()) { PlayOutMove(I - 1); }
     }
+
+    if(EndStep == NumSteps) { FinishMonteCarloPlan(); }
+    break;
+  default:
+    abort();
   }
+
+  PlanStep = EndStep;
+  if(PlanStep == NumSteps) { FinishPlan(); }
 }
 
+// Makes the moves that played out better than not attacking, best first,
+// then takes the other candidates as the Utility planner would.
 void
-AIDriver::LinkNearByBases(Base *PlayerBase, Game *MainGame)
+AIDriver::FinishMonteCarloPlan(void)
 {
-  World *GameWorld;
+  Ranking.clear();
+  for(int I = 0; I < (int) Moves.size(); I++) {
+    if(Moves[I].Gain > 0.0) { Ranking.push_back(I); }
+  }
 
-  GameWorld = MainGame->GetWorld();
+  std::sort(Ranking.begin(), Ranking.end(), [this](const int A, const int B) {
+    if(Moves[A].Gain != Moves[B].Gain) { return Moves[A].Gain > Moves[B].Gain; }
+
+    return A < B;
+  });
+
+  for(size_t I = 0; I < Ranking.size(); I++) { TakeMove(Moves[Ranking[I]]); }
+
+  // The attacks that were played out and lost are not made, the ones too
+  // unlikely to be worth playing out are left to their scores.
+  for(size_t I = 0; I < Moves.size(); I++) { MoveIndex[Moves[I].TargetBase] = I; }
+
+  for(size_t I = 0; I < Candidates.GetSize(); I++) {
+    if(Candidates.Type[I] != CommandType::Attack)  { continue; }
+    if(MoveIndex[Candidates.TargetBase[I]] < 0)    { continue; }
+    if(Moves[MoveIndex[Candidates.TargetBase[I]]].Gain > 0.0) { continue; }
+
+    Candidates.Score[I] = 0.0f;
+  }
 
-  for(int I = 0; I < GameWorld->GetBaseArraySize(); I++) {
-    Base *TargetBase = GameWorld->GetBaseFromArray(I);
+  for(size_t I = 0; I < Moves.size(); I++) { MoveIndex[Moves[I].TargetBase] = -1; }
+
+  TakeCandidates();
+}
+
+// Hands the plan over to CarryOutPlan().  On the pool, the driver may be
+// gone as soon as PlanLock is let go, so nothing may touch it after.
+void
+AIDriver::FinishPlan(void)
+{
+  Changes.clear();
+  Snapshot.reset();
+
+  std::lock_guard<std::mutex> Guard(PlanLock);
+
+  PlanReady = true;
+  PlanDone.notify_all();
+}
+
+const AIBaseState &
+AIDriver::GetBaseState(const int BaseNum) const
+{
+  const auto Changed = Changes.find(BaseNum);
+
+  return (Changed != Changes.end()) ? Changed->second : (*Snapshot)[BaseNum];
+}
+
+// The plan's own copy of a base, made the first time the plan changes it.
+AIBaseState &
+AIDriver::GetChangedBaseState(const int BaseNum)
+{
+  const auto Changed = Changes.find(BaseNum);
+
+  if(Changed != Changes.end()) { return Changed->second; }
+
+  return Changes.emplace(BaseNum, (*Snapshot)[BaseNum]).first->second;
+}
+
+// See ContinuePlan().
+int
+AIDriver::GetNumPlanSteps(void) const
+{
+  switch(Config.Planner) {
+  case AIPlanner::Dice:
+    return (int) Snapshot->size();
+  case AIPlanner::Utility:
+    return 2;
+  case AIPlanner::MonteCarlo:
+    return AI_ROLLOUT_MOVES + 2;
+  default:
+    abort();
+  }
+}
+
+// Whether to put the plan off a tick rather than carry it out.  A replay
+// puts it off when the match it recorded did, and a simulation that
+// delays late plans does while the pool is still making it, rather than
+// hold the tick up, and records that it did.
+bool
+AIDriver::IsPlanLate(Simulation *MainSimulation)
+{
+  bool Late;
+
+  if(Delayed) { return true; }
+  if(AIPool == nullptr || !MainSimulation->GetDelayLateAIPlans()) { return false; }
+
+  {
+    std::lock_guard<std::mutex> Guard(PlanLock);
+
+    Late = !PlanReady;
+  }
+
+  if(Late) { MainSimulation->RecordAIDelay(PlayerNum); }
+
+  return Late;
+}
+
+// Links the nearby bases of the player that are not fighting to
+// PlayerBase, as Base::ChangeTargetBase() will take it.
+void
+AIDriver::LinkNearByBases(const int PlayerBase)
+{
+  for(size_t I = 0; I < NearByBases.size(); I++) {
+    const int TargetBase = NearByBases[I];
+    const AIBaseState &Target = GetBaseState(TargetBase);
+
+    if(Target.AttackingBase < 0 && Target.IncomingAttacks == 0) {
+      if(Target.Owner != GetBaseState(PlayerBase).Owner)     { continue; }
+      if(GetBaseState(PlayerBase).TargetBase == TargetBase) { continue; }
 
-    if(!TargetBase->IsAttacking() &&
-       !GameWorld->IsBaseBeingAttacked(TargetBase)) {
 #if DEBUG_AI
-      std::cerr << "AI: Linking base: " << TargetBase->GetID()
-                << " to "               << PlayerBase->GetID() << std::endl;
+      std::cerr << "AI: Linking base: " << TargetBase
+                << " to "               << PlayerBase << std::endl;
 #endif /* _DEBUG_AI */
 
-      TargetBase->ChangeTargetBase(PlayerBase);
+      AddCommand(CommandType::Link, TargetBase, PlayerBase);
+      GetChangedBaseState(TargetBase).TargetBase = PlayerBase;
     }
   }
 }
 
+// Rolls for the bases from FirstBase up to EndBase the player holds in
+// the snapshot, each on its own.
 void
-AIDriver::ManageBase(Base *PlayerBase, Game *MainGame, std::minstd_rand &Rand)
+AIDriver::MakeDicePlan(const int FirstBase, const int EndBase)
 {
-  World *GameWorld;
+  for(int I = FirstBase; I < EndBase; I++) {
+    if((*Snapshot)[I].Owner == PlayerNum) { ManageBase(I); }
+  }
+}
+
+// Builds the candidates as the Utility planner does and plays the most
+// promising attacks out at once on the AI pool.  Each play-out gets its
+// rolls from a seed drawn here, so the plan does not depend on the
+// threads or the order the play-outs run in.
+void
+AIDriver::MakeMonteCarloPlan(void)
+{
+  int NumMoves;
+
+  BuildCandidates();
+  ChooseMoves();
+
+  NumMoves = (int) Moves.size();
+  if(NumMoves == 0) {
+    FinishMonteCarloPlan();
+    FinishPlan();
+
+    return;
+  }
+
+  // The last play-out finishes the plan, after which the driver may be
+  // gone, so the loop only counts with its own copy of the number.
+  MovesLeft = NumMoves;
+  for(int I = 0; I < NumMoves; I++) {
+    AIPool->Submit([this, I](void) {
+      PlayOutMove(I);
+      if(MovesLeft.fetch_sub(1) == 1) {
+        FinishMonteCarloPlan();
+        FinishPlan();
+      }
+    });
+  }
+}
+
+// Plans a whole decision on the AI pool with the configured planner.  It
+// only reads the snapshot and the world's bases and neighbour lists, none
+// of which the planners need change once the world is built.
+void
+AIDriver::MakePlan(void)
+{
+  PROFILE_ZONE(AI);
+
+#if DEBUG_AI
+  std::cerr << "AI: Player: " << PlayerToControl->GetID() << " Tick." << std::endl;
+#endif /* DEBUG_AI */
+
+  switch(Config.Planner) {
+  case AIPlanner::Dice:
+    MakeDicePlan(0, (int) Snapshot->size());
+    break;
+  case AIPlanner::Utility:
+    MakeUtilityPlan();
+    break;
+  case AIPlanner::MonteCarlo:
+    // Finished once its play-outs are.
+    MakeMonteCarloPlan();
+    return;
+  default:
+    abort();
+  }
+
+  FinishPlan();
+}
+
+// Builds every candidate of the decision, scores them all at once and
+// takes the best first.
+void
+AIDriver::MakeUtilityPlan(void)
+{
+  BuildCandidates();
+  TakeCandidates();
+}
+
+void
+AIDriver::ManageBase(const int PlayerBase)
+{
+  const BaseNeighbour *Neighbours;
+  int NumNeighbours;
 
   // Too few soldiers to do anything really useful.
-  if(PlayerBase->GetSoldiers() < 10.0) { return; }
+  if(GetBaseState(PlayerBase).Soldiers < 10.0) { return; }
+
+  Neighbours = GameWorld->GetBase(PlayerBase)->GetNeighbours(NumNeighbours);
 
-  GameWorld = MainGame->GetWorld();
+  NearByBases.clear();
+  for(int I = 0; I < NumNeighbours; I++) {
+    NearByBases.push_back(Neighbours[I].NeighbourBase->GetIndex());
+  }
+
+  if(NearByBases.size() > 0) {
+    const AIBaseState &Source = GetBaseState(PlayerBase);
 
-  GameWorld->GetNearByBases(PlayerBase, 24);
-  if(GameWorld->GetBaseArraySize() > 0) {
-    if(PlayerBase->IsAttacking() ||
-       GameWorld->IsBaseBeingAttacked(PlayerBase)) {
-      LinkNearByBases(PlayerBase, MainGame);
-      PlayerBase->ChangeTargetBase(nullptr);
+    if(Source.AttackingBase >= 0 || Source.IncomingAttacks > 0) {
+      LinkNearByBases(PlayerBase);
+      AddCommand(CommandType::Unlink, PlayerBase, -1);
+      GetChangedBaseState(PlayerBase).TargetBase = -1;
     } else {
-      CheckBasesToColonize(PlayerBase, MainGame, Rand);
-      CheckBasesToAttack(PlayerBase, MainGame, Rand);
-      MaybeUnlinkBase(PlayerBase, MainGame, Rand);
+      CheckBasesToColonize(PlayerBase);
+      CheckBasesToAttack(PlayerBase);
+      MaybeUnlinkBase(PlayerBase);
     }
   }
 }
 
 void
-AIDriver::MaybeUnlinkBase(Base *PlayerBase, Game *MainGame, std::minstd_rand &Rand)
+AIDriver::MaybeUnlinkBase(const int PlayerBase)
 {
-  World *GameWorld;
-
-  GameWorld = MainGame->GetWorld();
+  const AIBaseState &Source = GetBaseState(PlayerBase);
 
-  if(GameWorld->IsBaseBeingAttacked(PlayerBase)) {
+  if(Source.IncomingAttacks > 0) {
 #if DEBUG_AI
-    std::cerr << "AI: Unlinking base: " << PlayerBase->GetID()
+    std::cerr << "AI: Unlinking base: " << PlayerBase
               << " for defense."        << std::endl;
 #endif /* DEBUG_AI */
 
-    PlayerBase->ChangeTargetBase(nullptr);
+    AddCommand(CommandType::Unlink, PlayerBase, -1);
+    GetChangedBaseState(PlayerBase).TargetBase = -1;
 
     return;
   }
 
-  if(PlayerBase->GetTargetBase() != nullptr) {
-    if(!GameWorld->IsBaseBeingAttacked(PlayerBase->GetTargetBase()) &&
-       (Rand() % AI_CHANCE_TO_UNLINK_BASE) == 0) {
+  if(Source.TargetBase >= 0) {
+    if(GetBaseState(Source.TargetBase).IncomingAttacks == 0 &&
+       (Rand() % Config.ChanceToUnlinkBase) == 0) {
 #if DEBUG_AI
-      std::cerr << "AI: Unlinking base: "         << PlayerBase->GetID()
+      std::cerr << "AI: Unlinking base: "         << PlayerBase
                 << " since it is doing nothing. " << std::endl;
 #endif /* DEBUG_AI */
       // Check if an enemy base is nearby.
-      for(int I = 0; I < GameWorld->GetBaseArraySize(); I++) {
-        const Base *TargetBase = GameWorld->GetBaseFromArray(I);
-
-        if(TargetBase->GetOwner() != nullptr) {
-          if(TargetBase->GetOwner()->GetID() != PlayerBase->GetOwner()->GetID()) {
-            // If an enemy is nearby, then unlink the base.
-            PlayerBase->ChangeTargetBase(nullptr);
-          }
+      for(size_t I = 0; I < NearByBases.size(); I++) {
+        const AIBaseState &Target = GetBaseState(NearByBases[I]);
+
+        // If an enemy is nearby, then unlink the base.
+        if(Target.Owner >= 0 && Target.Owner != PlayerNum) {
+          AddCommand(CommandType::Unlink, PlayerBase, -1);
+          GetChangedBaseState(PlayerBase).TargetBase = -1;
+          break;
+        }
+      }
+    }
+  }
+}
+
+// Plays a move out AI_ROLLOUTS times for AI_ROLLOUT_TIME, each with its
+// own rolls for the attacks, and compares the mean value with a play-out
+// without the move.  Only touches the move, so the moves of a decision
+// can be played out at once.
+void
+AIDriver::PlayOutMove(const int MoveNum)
+{
+  AIMove &Move = Moves[MoveNum];
+  std::minstd_rand PlayOutRand(Move.Seed);
+  std::vector<AIPlayOutBase> Bases;
+  double StayValue;
+  double TotalValue = 0.0;
+
+  Bases = Move.Start;
+  for(double Time = 0.0; Time < AI_ROLLOUT_TIME; Time += AI_ROLLOUT_STEP) {
+    StepPlayOut(Bases, (float) AI_ROLLOUT_STEP);
+  }
+  StayValue = GetPlayOutValue(Bases, PlayerNum);
+
+  for(int I = 0; I < AI_ROLLOUTS; I++) {
+    Bases = Move.Start;
+
+    // As Base::AttackBase() rolls them.
+    for(size_t J = 0; J < Move.Attackers.size(); J++) {
+      AIPlayOutBase &Attacker = Bases[Move.Attackers[J]];
+      const int AttackRoll = (int) (PlayOutRand() % 16) + 1;
+      const int DefenseRoll = (int) (PlayOutRand() % 16) + 1 + Move.TargetDefence;
+
+      Attacker.TargetBase = -1;
+      Attacker.AttackingBase = PlayOutTarget;
+      Attacker.AttackRate = Candidates.Efficiency[Move.Candidates[J]];
+      Attacker.Roll = (4.0f + (float) AttackRoll) / (4.0f + (float) DefenseRoll);
+    }
+
+    for(double Time = 0.0; Time < AI_ROLLOUT_TIME; Time += AI_ROLLOUT_STEP) {
+      StepPlayOut(Bases, (float) AI_ROLLOUT_STEP);
+    }
+    TotalValue += GetPlayOutValue(Bases, PlayerNum);
+  }
+
+  Move.Gain = (TotalValue / AI_ROLLOUTS) - StayValue;
+}
+
+// The utility of every candidate, in one loop without branches so that
+// it vectorizes.  An attack is worth the growth of the target when the
+// attacks the player could make on it are expected to beat the defenders
+// by AI_ATTACK_MARGIN, less for a slow attack or for a source the enemies
+// around could take once it has spent its soldiers.  A colony is worth
+// its growth, and a link how fast it moves soldiers on.
+void
+AIDriver::ScoreCandidates(void)
+{
+  const int NumCandidates = (int) Candidates.GetSize();
+  const CommandType *Type = Candidates.Type.data();
+  const float *TargetSoldiers = Candidates.TargetSoldiers.data();
+  const float *TargetSize = Candidates.TargetSize.data();
+  const float *Efficiency = Candidates.Efficiency.data();
+  const float *Support = Candidates.Support.data();
+  const float *Threat = Candidates.Threat.data();
+  float *Score;
+
+  Candidates.Score.resize(NumCandidates);
+  Score = Candidates.Score.data();
+
+  for(int I = 0; I < NumCandidates; I++) {
+    const float IsAttack = (float) (Type[I] == CommandType::Attack);
+    const float IsColonize = (float) (Type[I] == CommandType::Colonize);
+    const float IsLink = (float) (Type[I] == CommandType::Link);
+    const float Growth = 1.0f + (TargetSize[I] / 9.0f);
+    const float Odds = Support[I] / (TargetSoldiers[I] + 1.0f);
+    const float Attack = (((Odds - (float) AI_ATTACK_MARGIN) * Efficiency[I]) - (0.5f * Threat[I])) * Growth;
+    const float Colonize = 2.0f * Growth * Efficiency[I];
+    const float Link = 4.0f * Efficiency[I];
+
+    Score[I] = (IsAttack * Attack) + (IsColonize * Colonize) + (IsLink * Link);
+  }
+}
+
+// Takes the snapshot and plans from it, on the AI pool if there is one
+// and from the next tick on otherwise.
+void
+AIDriver::StartPlan(Simulation *MainSimulation)
+{
+  ThreadPool *AIPool = MainSimulation->GetAIPool();
+
+  GameWorld = MainSimulation->GetWorld();
+  Snapshot = MainSimulation->GetAISnapshot();
+  this->AIPool = AIPool;
+  Planning = true;
+  PlanStep = 0;
+  PlanReady = false;
+
+  if(AIPool != nullptr) { AIPool->Submit([this](void) { MakePlan(); }); }
+}
+
+// Sums the expected damage of all the attacks on each target, so that
+// bases too weak to take a target alone can take it together.  Pledged
+// is free to add them up in until the candidates are taken.
+void
+AIDriver::SumSupport(void)
+{
+  for(size_t I = 0; I < Candidates.GetSize(); I++) {
+    Pledged[Candidates.TargetBase[I]] += Candidates.Damage[I];
+  }
+
+  for(size_t I = 0; I < Candidates.GetSize(); I++) {
+    Candidates.Support[I] = Pledged[Candidates.TargetBase[I]];
+  }
+
+  for(size_t I = 0; I < Candidates.GetSize(); I++) {
+    Pledged[Candidates.TargetBase[I]] = 0.0f;
+  }
+}
+
+// Adds candidate I to the plan unless the candidates taken before it
+// made it impossible or needless, as the bases will take it.
+void
+AIDriver::TakeCandidate(const int I)
+{
+  const int SrcBase = Candidates.SrcBase[I];
+  const int TargetBase = Candidates.TargetBase[I];
+  const AIBaseState &Source = GetBaseState(SrcBase);
+  const AIBaseState &Target = GetBaseState(TargetBase);
+
+  switch(Candidates.Type[I]) {
+  case CommandType::Attack:
+    if(Ordered[SrcBase] || Source.AttackingBase >= 0 || Source.Soldiers < 10.0) { return; }
+    if(Pledged[TargetBase] >= Target.Soldiers * AI_ATTACK_MARGIN)               { return; }
+
+    AddAttack(I);
+    break;
+  case CommandType::Colonize:
+    if(Target.Owner >= 0 || Source.Soldiers < 10.0) { return; }
+
+#if DEBUG_AI
+    std::cerr << "AI: Colonize base: " << TargetBase
+              << " from "              << SrcBase << std::endl;
+#endif /* DEBUG_AI */
+
+    AddCommand(CommandType::Colonize, SrcBase, TargetBase);
+    GetChangedBaseState(TargetBase).Owner = PlayerNum;
+    GetChangedBaseState(TargetBase).Soldiers = 5.0;
+    GetChangedBaseState(SrcBase).Soldiers -= 5.0;
+
+    // Colonizing leaves the base free for an attack or a link.
+    return;
+  case CommandType::Link:
+    if(Ordered[SrcBase] || Source.AttackingBase >= 0 || Source.IncomingAttacks > 0) { return; }
+
+    if(Source.TargetBase != TargetBase) {
+#if DEBUG_AI
+      std::cerr << "AI: Linking base: " << SrcBase
+                << " to "               << TargetBase << std::endl;
+#endif /* DEBUG_AI */
+
+      AddCommand(CommandType::Link, SrcBase, TargetBase);
+      GetChangedBaseState(SrcBase).TargetBase = TargetBase;
+    }
+    break;
+  default:
+    abort();
+  }
+
+  Ordered[SrcBase] = 1;
+}
+
+// Takes the candidates best first, with at most one attack or link for
+// each base, and clears the scratch space for the next decision.
+void
+AIDriver::TakeCandidates(void)
+{
+  Ranking.clear();
+  for(int I = 0; I < (int) Candidates.GetSize(); I++) {
+    if(Candidates.Score[I] > 0.0f) { Ranking.push_back(I); }
+  }
+
+  std::sort(Ranking.begin(), Ranking.end(), [this](const int A, const int B) {
+    if(Candidates.Score[A] != Candidates.Score[B]) {
+      return Candidates.Score[A] > Candidates.Score[B];
+    }
+
+    return A < B;
+  });
+
+  for(size_t I = 0; I < Ranking.size(); I++) { TakeCandidate(Ranking[I]); }
+
+  // Bases under attack keep their soldiers, and so do the bases at the
+  // front that have nothing better to do.
+  for(size_t I = 0; I < OwnBases.size(); I++) {
+    const int PlayerBase = OwnBases[I];
+    const AIBaseState &Source = GetBaseState(PlayerBase);
+
+    if(Ordered[PlayerBase] || Source.TargetBase < 0) { continue; }
+
+    if(Source.IncomingAttacks > 0 || FrontDistance[PlayerBase] == 0) {
+#if DEBUG_AI
+      std::cerr << "AI: Unlinking base: " << PlayerBase
+                << " to hold the front."  << std::endl;
+#endif /* DEBUG_AI */
+
+      AddCommand(CommandType::Unlink, PlayerBase, -1);
+      GetChangedBaseState(PlayerBase).TargetBase = -1;
+    }
+  }
+
+  for(size_t I = 0; I < OwnBases.size(); I++) { Ordered[OwnBases[I]] = 0; }
+  for(size_t I = 0; I < Candidates.GetSize(); I++) { Pledged[Candidates.TargetBase[I]] = 0.0f; }
+}
+
+// Makes every attack of a move, unless the moves before it took one of
+// its attackers.
+void
+AIDriver::TakeMove(const AIMove &Move)
+{
+  for(size_t I = 0; I < Move.Candidates.size(); I++) {
+    const int SrcBase = Candidates.SrcBase[Move.Candidates[I]];
+    const AIBaseState &Source = GetBaseState(SrcBase);
+
+    if(Ordered[SrcBase] || Source.AttackingBase >= 0 || Source.Soldiers <= 10.0) { return; }
+  }
+
+  for(size_t I = 0; I < Move.Candidates.size(); I++) {
+    AddAttack(Move.Candidates[I]);
+    Ordered[Candidates.SrcBase[Move.Candidates[I]]] = 1;
+  }
+}
+
+// Makes sure the plan is ready, making what is left of it here if there
+// is no pool.
+void
+AIDriver::WaitForPlan(void)
+{
+  if(AIPool == nullptr) {
+    if(!PlanReady) { ContinuePlan(GetNumPlanSteps()); }
+
+    return;
+  }
+
+  std::unique_lock<std::mutex> Guard(PlanLock);
+
+  PlanDone.wait(Guard, [this](void) { return PlanReady; });
+}
+
+// Helper Functions for AIDriver
+// What the soldiers a base can spare are expected to kill of a base with
+// DefenceValue, the attack and defense rolls at their mean of 8.5.
+static double
+GetExpectedDamage(const double Soldiers, const int DefenceValue)
+{
+  const double Spare = std::max(Soldiers - 10.0, 0.0);
+
+  return (Spare * (4.0 + 8.5)) / (4.0 + 8.5 + (double) DefenceValue);
+}
+
+// The soldiers of the player in a play-out less those of its enemies,
+// with each base counted as AI_ROLLOUT_BASE_VALUE seconds of its growth.
+static double
+GetPlayOutValue(const std::vector<AIPlayOutBase> &Bases, const int PlayerNum)
+{
+  double Value = 0.0;
+
+  for(size_t I = 0; I < Bases.size(); I++) {
+    const AIPlayOutBase &PlayOutBase = Bases[I];
+    const double BaseValue = PlayOutBase.Soldiers + (PlayOutBase.Growth * AI_ROLLOUT_BASE_VALUE);
+
+    if(PlayOutBase.Owner == PlayerNum) {
+      Value += BaseValue;
+    } else if(PlayOutBase.Owner >= 0) {
+      Value -= BaseValue;
+    }
+  }
+
+  return Value;
+}
+
+// One step of a play-out, with the rules of BaseTable::Grow() and
+// Base::Tick() for the bases of the play-out.  It differs from them in
+// that:
+// - it runs in floats, on steps of AI_ROLLOUT_STEP rather than a tick;
+// - an attack spends no more soldiers than it takes to take the target;
+// - a taken base grows as an AI's would, and nobody scores.
+// Anything else changed in Base::Tick() needs changing here too.
+static void
+StepPlayOut(std::vector<AIPlayOutBase> &Bases, const float Delta)
+{
+  for(size_t I = 0; I < Bases.size(); I++) {
+    if(Bases[I].Owner >= 0) {
+      Bases[I].Soldiers = std::min(Bases[I].Soldiers + (Bases[I].Growth * Delta),
+                                   (float) MAX_BASE_SOLDIERS);
+    }
+  }
+
+  for(size_t I = 0; I < Bases.size(); I++) {
+    AIPlayOutBase &Source = Bases[I];
+
+    if(Source.Owner < 0) { continue; }
+
+    if(Source.TargetBase >= 0) {
+      AIPlayOutBase &Target = Bases[Source.TargetBase];
+
+      if(Target.Owner != Source.Owner) {
+        Source.TargetBase = -1;
+      } else {
+        const float Move = (Source.Soldiers * Source.TransferRate) * Delta;
+
+        if(Target.Soldiers + Move < (float) MAX_BASE_SOLDIERS) {
+          Source.Soldiers -= Move;
+          Target.Soldiers += Move;
         }
       }
     }
+
+    if(Source.AttackingBase >= 0) {
+      AIPlayOutBase &Target = Bases[Source.AttackingBase];
+      float AttackingSoldiers = (Source.Soldiers * Source.AttackRate) * Delta;
+
+      if(Target.Owner == Source.Owner) {
+        Source.AttackingBase = -1;
+
+        continue;
+      }
+
+      if(AttackingSoldiers >= Source.Soldiers - 10.0f) {
+        AttackingSoldiers = Source.Soldiers - 9.9f;
+      }
+
+      // The game takes the base within a tick of the damage being enough,
+      // which a step is far longer than.
+      AttackingSoldiers = std::min(AttackingSoldiers, (Target.Soldiers / Source.Roll) + 0.1f);
+
+      Source.Soldiers -= AttackingSoldiers;
+      Target.Soldiers -= AttackingSoldiers * Source.Roll;
+
+      if(Target.Soldiers <= 0.0f) {
+        Target.Owner = Source.Owner;
+        Target.Growth = Target.CaptureGrowth;
+        Target.TargetBase = -1;
+        Target.AttackingBase = -1;
+        Target.Soldiers = Source.Soldiers * 0.5f;
+        Source.Soldiers *= 0.5f;
+        Source.AttackingBase = -1;
+      } else if(Source.Soldiers <= 10.0f) {
+        Source.AttackingBase = -1;
+      }
+    }
   }
 }
@@ -23,27 +23,170 @@
 
 class AIDriver;
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <random>
+#include <unordered_map>
+#include <vector>
 
-#include "Game.hpp"
+#include "AiConfig.hpp"
 #include "Player.hpp"
+#include "Replay.hpp"
+#include "Simulation.hpp"
 
+// The moves open to a player in one Utility decision, one for every base
+// it holds and neighbour worth a command.  Each field is an array of its
+// own, so ScoreCandidates() is one plain loop over them.
+struct AICandidates {
+  std::vector<CommandType> Type; // Attack, Colonize or Link
+  std::vector<int> SrcBase;
+  std::vector<int> TargetBase;
+  std::vector<float> TargetSoldiers;
+  std::vector<float> TargetSize;
+  std::vector<float> Efficiency; // Of an attack or a link over the distance
+  std::vector<float> Damage;     // Expected damage of the source's attack
+  std::vector<float> Support;    // Expected damage of all attacks on the target
+  std::vector<float> Threat;     // Enemy soldiers next to the source over its own
+  std::vector<float> Score;
+
+  void Add(const CommandType Type,
+           const int SrcBase, const int TargetBase, const AIBaseState &Target,
+           const double Efficiency, const double Damage);
+  void Clear(void);
+  size_t GetSize(void) const { return Type.size(); }
+};
+
+// A base in a MonteCarlo play-out.  The bases are a flat copy of the
+// snapshot around one attack, so a play-out is cheap to set up and to
+// step, and bases are indices into the copy.
+struct AIPlayOutBase {
+  float Soldiers;
+  float Growth;
+  float CaptureGrowth; // Growth once an AI takes it
+  float TransferRate;
+  float AttackRate;
+  float Roll;
+  int Owner;           // Player number, -1 for none
+  int TargetBase;      // -1 for none or a base outside the play-out
+  int AttackingBase;   // -1 for none or a base outside the play-out
+};
+
+// An attack the MonteCarlo planner plays out: every attack candidate on
+// TargetBase at once, against the bases around them.
+struct AIMove {
+  int TargetBase;
+  int TargetDefence;
+  uint32_t Seed;
+  std::vector<int> Candidates;      // The attack candidates it is made of
+  std::vector<int> Attackers;       // Their sources in the play-out
+  std::vector<int> Bases;           // The snapshot bases of the play-out
+  std::vector<AIPlayOutBase> Start; // As in the snapshot
+  double Gain;                      // Mean value of the attack over not attacking
+};
+
+// A computer player.  Each decision is planned from a snapshot of the
+// bases taken when it starts, on the simulation's AI pool if it has one,
+// into a list of commands that are carried out AI_PLAN_TIME later.  The
+// plan only depends on the snapshot and the AI's own random numbers, so a
+// match goes the same way whether the AI plans on a thread or not.
+//
+// Without a pool the plan is made a few steps a tick, spread over
+// AI_PLAN_TIME, so a decision does not land on one tick.  With one, a
+// plan the pool has not finished in time is waited for, or put off a
+// tick at a time if the simulation delays late plans.
 class AIDriver {
 private:
   double Ticks;
+  AIConfig Config;
   Player *PlayerToControl;
+  int PlayerNum;
+  std::minstd_rand Rand;
+
+  // The plan being made or waiting to be carried out.  Changes holds the
+  // bases the plan has changed so far, the rest are read from Snapshot.
+  bool Planning;
+  bool Delayed; // Put the plan off this tick, as a replay says
+  int PlanStep; // Next step of a plan made without a pool
+  std::shared_ptr<const std::vector<AIBaseState>> Snapshot;
+  std::unordered_map<int, AIBaseState> Changes;
+  std::vector<Command> Plan;
+  std::vector<int> NearByBases;
+  World *GameWorld;
+
+  // Scratch space of the Utility planner, kept between decisions.  The
+  // per base arrays are only touched for the player's own bases and the
+  // targets of its candidates.
+  AICandidates Candidates;
+  std::vector<int> Ranking;
+  std::vector<int> OwnBases;
+  std::vector<int> FrontDistance;
+  std::vector<int> FrontQueue;
+  std::vector<float> Pledged;
+  std::vector<uint8_t> Ordered;
+
+  // The attacks of a MonteCarlo decision.  Their play-outs run on the AI
+  // pool, and the last one to finish finishes the plan.
+  ThreadPool *AIPool;
+  std::vector<AIMove> Moves;
+  std::atomic<int> MovesLeft;
+  std::vector<int> MoveIndex;
+  std::vector<int> PlayOutIndex;
+
+  std::mutex PlanLock;
+  std::condition_variable PlanDone;
+  bool PlanReady;
 
-  void CheckBases(Game *MainGame, std::minstd_rand &Rand);
-  void CheckBasesToAttack(Base *PlayerBase, Game *MainGame, std::minstd_rand &Rand);
-  void CheckBasesToColonize(Base *PlayerBase, Game *MainGame, std::minstd_rand &Rand);
-  void LinkNearByBases(Base *PlayerBase, Game *MainGame);
-  void ManageBase(Base *PlayerBase, Game *MainGame, std::minstd_rand &Rand);
-  void MaybeUnlinkBase(Base *PlayerBase, Game *MainGame, std::minstd_rand &Rand);
+  void AddAttack(const int I);
+  void AddCommand(const CommandType Type, const int SrcBase, const int TargetBase);
+  void AddFrontCandidates(const int PlayerBase);
+  void AddLinkCandidates(void);
+  void AddPlayOutBase(AIMove &Move, const int BaseNum);
+  void BuildCandidates(void);
+  void BuildMove(AIMove &Move);
+  void CarryOutPlan(Simulation *MainSimulation);
+  void CheckBasesToAttack(const int PlayerBase);
+  void CheckBasesToColonize(const int PlayerBase);
+  void ChooseMoves(void);
+  void ContinuePlan(const int EndStep);
+  void FinishMonteCarloPlan(void);
+  void FinishPlan(void);
+  const AIBaseState &GetBaseState(const int BaseNum) const;
+  AIBaseState &GetChangedBaseState(const int BaseNum);
+  int GetNumPlanSteps(void) const;
+  bool IsPlanLate(Simulation *MainSimulation);
+  void LinkNearByBases(const int PlayerBase);
+  void MakeDicePlan(const int FirstBase, const int EndBase);
+  void MakeMonteCarloPlan(void);
+  void MakePlan(void);
+  void MakeUtilityPlan(void);
+  void ManageBase(const int PlayerBase);
+  void MaybeUnlinkBase(const int PlayerBase);
+  void PlayOutMove(const int MoveNum);
+  void ScoreCandidates(void);
+  void StartPlan(Simulation *MainSimulation);
+  void SumSupport(void);
+  void TakeCandidate(const int I);
+  void TakeCandidates(void);
+  void TakeMove(const AIMove &Move);
+  void WaitForPlan(void);
 public:
   AIDriver(void) { }
-  ~AIDriver(void) { }
-  bool Create(Player *PlayerToControl);
-  void Tick(Game *MainGame, const double Delta, std::minstd_rand &Rand);
+  ~AIDriver(void) { if(AIPool != nullptr) { WaitForPlan(); } }
+  void ChangePlan(const Command *Commands, const int NumCommands);
+  void ChangeRandState(const uint32_t State) { Rand.seed(State); }
+  void ChangeTicks(const double Ticks) { this->Ticks = Ticks; }
+  bool Create(Player *PlayerToControl,
+              const AIConfig &Config,
+              const double Phase, const unsigned int Seed);
+  void DelayPlan(void) { Delayed = true; }
+  const AIConfig &GetConfig(void) const { return Config; }
+  const std::vector<Command> &GetPlan(void);
+  uint32_t GetRandState(void) const;
+  double GetTicks(void) const { return Ticks; }
+  void Tick(Simulation *MainSimulation, const double Delta);
 };
 
 #endif // _AI_HPP_
@@ -0,0 +1,56 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _AICONFIG_HPP_
+#define _AICONFIG_HPP_
+
+struct AIConfig;
+
+#include "Config.hpp"
+
+// How a computer player picks its commands.  The chances of AIConfig
+// only steer the Dice planner.
+enum class AIPlanner {
+  Dice,      // Rolls for every base and neighbour on its own
+  Utility,   // Scores every move of a decision and takes the best ones first
+  MonteCarlo // Utility, with its attacks played out before they are made
+};
+
+#define NUM_AI_PLANNERS 3
+
+// The tunables of a computer player, so matches can pit differently
+// tuned AIs against each other.
+struct AIConfig {
+  double DecisionTime;             // How many seconds before the AI makes a decision
+  unsigned int ChanceToAttack;     // (1/N) Chance
+  unsigned int ChanceToColonize;   // (1/N) Chance
+  unsigned int ChanceToUnlinkBase; // (1/N) Chance
+  AIPlanner Planner;
+};
+
+static const AIConfig DefaultAIConfig = {
+  AI_DECISION_TIME,
+  AI_CHANCE_TO_ATTACK,
+  AI_CHANCE_TO_COLONIZE,
+  AI_CHANCE_TO_UNLINK_BASE,
+  AIPlanner::Utility
+};
+
+#endif // _AICONFIG_HPP_
@@ -20,6 +20,7 @@
 
 #include "Application.hpp"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
@@ -29,14 +30,24 @@
 #include <SDL2/SDL_mouse.h>
 #include <SDL2/SDL_timer.h>
 
+#include "Config.hpp"
 #include "MainMenu.hpp"
+#include "Profiler.hpp"
 
 static const char *ConfigFileName = "Config.bcf";
+static const char *ProfileFileName = "Profile.csv";
+static const char *TraceFileName = "Profile.json";
+static const char *ReplayFileName = "LastGame.bcr";
+static const char *SaveFileName = "Autosave.bcs";
 
 BcApplication::~BcApplication(void)
 {
   if(Menus != nullptr)    { delete Menus; }
-  if(MainGame != nullptr) { delete MainGame; }
+  if(MainGame != nullptr) {
+    SaveGame();
+    SaveReplay();
+    delete MainGame;
+  }
 
   delete Video;
   delete Audio;
@@ -63,6 +74,31 @@ BcApplication::ChangeMenu(Menu *NewMenu)
   this->NewMenu = NewMenu;
 }
 
+// Carries on the game that was autosaved last.
+bool
+BcApplication::ContinueGame(void)
+{
+  char *Buffer = GetFilePath(SaveFileName);
+
+  MainGame = new Game();
+
+  if(!MainGame->Load(Buffer, Video, Audio)) {
+    delete[] Buffer;
+    delete MainGame;
+
+    MainGame = nullptr;
+
+    return false;
+  }
+
+  delete[] Buffer;
+
+  MainGame->ChangeShowGrid(ShowGrid);
+  AutosaveTicks = 0;
+
+  return true;
+}
+
 const char *
 BcApplication::GetApplicationPath(void) const
 {
@@ -120,6 +156,7 @@ BcApplication::Init(void)
 
   NewMenu = nullptr;
   Menus = nullptr;
+  LeftMouseButtonPressed = false;
   EndGame_ = false;
   MainGame = nullptr;
   Running = true;
@@ -147,11 +184,15 @@ BcApplication::Init(void)
 void
 BcApplication::Loop(void)
 {
-  Uint32 PrevTick = 0;
-  Uint32 Tick;
+  const double TickDelta = 1.0 / (double) SIMULATION_TICK_RATE;
+  const Uint64 Frequency = SDL_GetPerformanceFrequency();
+
+  Uint64 PrevCounter = SDL_GetPerformanceCounter();
+  double Accumulator = 0.0;
+  Uint64 Counter;
   int X, Y;
-  int ret;
   SDL_Event Event;
+  bool Redraw = true;
 
   while(Running) {
     if(MainGame == nullptr) {
@@ -161,12 +202,15 @@ BcApplication::Loop(void)
     }
 
     if(EndGame_) {
+      SaveGame();
+      SaveReplay();
       delete MainGame;
 
       MainGame = nullptr;
       EndGame_ = false;
 
       CreateMainMenu(this);
+      Redraw = true;
     }
 
     if(NewMenu != nullptr) {
@@ -174,63 +218,117 @@ BcApplication::Loop(void)
 
       Menus = NewMenu;
       NewMenu = nullptr;
-    }
-
-    Video->Clear();
-    if(MainGame != nullptr) {
-      if(Menus != nullptr) {
-        delete Menus;
+      Redraw = true;
+    }
+
+    // The screen only changes on input or a simulation tick.  Until one of
+    // them comes, wait instead of drawing the same frame again: for the next
+    // tick in a game, or a while for input in a menu or a paused game.
+    if(!Redraw) {
+      int Timeout = IDLE_WAIT_TIME;
 
-        Menus = nullptr;
+      if(MainGame != nullptr && !MainGame->IsWindowOpen()) {
+        Timeout = std::min((int) ((TickDelta - Accumulator) * 1000.0), IDLE_WAIT_TIME);
       }
-
-      MainGame->Draw(Video);
-    } else {
-      Menus->Draw(Video, 0, 0);
-    }
 
-    SDL_GetMouseState(&X, &Y);
-    Video->DrawCursor(X, Y);
-
-    Video->Finish();
+      if(Timeout > 0) { SDL_WaitEventTimeout(nullptr, Timeout); }
+    }
 
-    ret = SDL_PollEvent(&Event);
-    if(ret == 1) {
-      switch(Event.type) {
+    // Handle every event that came in since the last frame.
+    while(SDL_PollEvent(&Event) == 1) {
+      Redraw = true;
+
+      switch(Event.type) {
       case SDL_QUIT:
         if(MainGame != nullptr) {
-          MainGame->Input(&Event, Video, Rand);
-        } else {
+          MainGame->Input(&Event, Video);
+        } else {
           Running = false;
-        }
-        break;
-      default:
-        if(MainGame != nullptr) {
-          MainGame->Input(&Event, Video, Rand);
-        } else {
-          Input();
-        }
-      }
-
-      SDL_PumpEvents();
-      SDL_FlushEvents(SDL_KEYDOWN, SDL_MULTIGESTURE);
-    }
+        }
+        break;
+#if ENABLE_PROFILER
+      case SDL_KEYDOWN:
+        if(Event.key.keysym.scancode == SDL_SCANCODE_F3) {
+          if(!Event.key.repeat) { Profiler::ChangeEnabled(!Profiler::IsEnabled()); }
+          break;
+        }
+        // Fall through
+#endif // ENABLE_PROFILER
+      default:
+        if(MainGame != nullptr) {
+          MainGame->Input(&Event, Video);
+        } else if(Menus != nullptr) {
+          Input();
+        }
+      }
+
+      // Let the new menu or the end of the game take effect first.
+      if(NewMenu != nullptr || EndGame_ || !Running) { break; }
+    }
+
+    // Run the simulation in fixed steps for the time that has passed,
+    // dropping the rest if it falls too far behind.
+    Counter = SDL_GetPerformanceCounter();
+    Accumulator += (double) (Counter - PrevCounter) / (double) Frequency;
+    PrevCounter = Counter;
+
+    if(MainGame != nullptr) {
+      int Steps = 0;
+
+      while(Accumulator >= TickDelta) {
+        if(Steps++ == MAX_SIMULATION_STEPS) {
+          Accumulator = 0.0;
+          break;
+        }
+
+        if(MainGame->Tick(TickDelta, Video, Rand)) { Redraw = true; }
+        Accumulator -= TickDelta;
+        AutosaveTicks++;
+      }
+
+      if(AutosaveTicks >= AUTOSAVE_INTERVAL * SIMULATION_TICK_RATE) {
+        SaveGame();
+        AutosaveTicks = 0;
+      }
+    } else {
+      Accumulator = 0.0;
+    }
+
+    if(MainGame != nullptr && Menus != nullptr) {
+      delete Menus;
+
+      Menus = nullptr;
+    }
+
+    if(Redraw) {
+      Video->Clear();
+      if(MainGame != nullptr) {
+        MainGame->Draw(Video);
+      } else {
+        Menus->Draw(Video, 0, 0);
+      }
 
-    Tick = SDL_GetTicks();
-    if(PrevTick == 0) {
-      if(MainGame != nullptr) {
-        MainGame->Tick((double) Tick / 1000.0, Video, Rand);
-      }
-    } else {
-      if(MainGame != nullptr) {
-        MainGame->Tick((double) (Tick - PrevTick) / 1000.0, Video, Rand);
-      }
-    }
+#if ENABLE_PROFILER
+      if(Profiler::IsEnabled()) { DrawProfiler(); }
+#endif // ENABLE_PROFILER
+
+      SDL_GetMouseState(&X, &Y);
+      Video->DrawCursor(X, Y);
 
-    PrevTick = Tick;
+      Video->Finish();
+      Redraw = false;
+    }
 
     Audio->Tick();
+
+#if ENABLE_PROFILER
+    Profiler::EndFrame();
+#endif // ENABLE_PROFILER
   }
+
+#if ENABLE_PROFILER
+  SaveProfile();
+#endif // ENABLE_PROFILER
 }
 
 void
@@ -260,8 +358,9 @@ BcApplication::NewGame(void)
 {
   MainGame = new Game();
 
-  MainGame->Init(DifficultyValue, Video, Rand);
+  MainGame->Init(DefaultWorldSettings, DifficultyValue, Video, Audio, Rand);
   MainGame->ChangeShowGrid(ShowGrid);
+  AutosaveTicks = 0;
 }
 
 bool
@@ -312,10 +411,78 @@ BcApplication::Stop(void)
 }
 
 // Private Functions of Application
+#if ENABLE_PROFILER
+// Lists the average and worst time of every zone over the frames kept,
+// above a graph of the frame time.  The line across it marks 60 FPS.
+void
+BcApplication::DrawProfiler(void)
+{
+  const int NumFrames = std::min(Profiler::GetNumFrames(), PROFILER_HISTORY);
+  const int LineHeight = FONT_HEIGHT + 2;
+  const int GraphHeight = 64;
+  const double GraphScale = GraphHeight / (2000.0 / SIMULATION_TICK_RATE); // Pixels per ms
+  const int Width = 36 * FONT_WIDTH;
+  const int Height = (NUM_PROFILE_ZONES + 1) * LineHeight + GraphHeight + 24;
+  const int X = 8;
+  const int Y = 8;
+  const int GraphY = Y + Height - 8;
+  char Line[64];
+
+  Video->DrawRect(Width, Height, X, Y, 0x22, 0x22, 0x22, 0xFF);
+  Video->DrawBox(Width, Height, X, Y, 0x66, 0x66, 0x66, 0xFF);
+
+  snprintf(Line, sizeof(Line), "%-20s %6s %6s", "Zone", "Avg ms", "Max ms");
+  Video->DrawStr(Line, X + 8, Y + 8, 1.0);
+
+  for(int I = 0; I < NUM_PROFILE_ZONES; I++) {
+    const ProfileZone Zone = (ProfileZone) I;
+    double Total = 0.0, Worst = 0.0;
+
+    for(int J = 0; J < NumFrames; J++) {
+      const double Time = Profiler::GetFrameTime(J, Zone);
+
+      Total += Time;
+      Worst = std::max(Worst, Time);
+    }
+
+    snprintf(Line, sizeof(Line), "%-20s %6.2f %6.2f",
+             Profiler::GetZoneName(Zone), (NumFrames > 0) ? Total / NumFrames : 0.0, Worst);
+    Video->DrawStr(Line, X + 8, Y + 8 + (I + 1) * LineHeight, 1.0);
+  }
+
+  // Newest frame on the right, two pixels per frame.
+  for(int J = 0; J < NumFrames; J++) {
+    const double Time = Profiler::GetFrameTime(J, ProfileZone::Loop);
+    const int BarHeight = std::min((int) (Time * GraphScale), GraphHeight);
+
+    Video->DrawRect(2, BarHeight,
+                    X + 8 + (PROFILER_HISTORY - 1 - J) * 2, GraphY - BarHeight,
+                    (BarHeight == GraphHeight) ? 0xFF : 0x44, 0xCC, 0x44, 0xFF);
+  }
+
+  Video->DrawLine(X + 8, GraphY - GraphHeight / 2,
+                  X + 8 + PROFILER_HISTORY * 2, GraphY - GraphHeight / 2,
+                  0xFF, 0xFF, 0xFF, 0xFF);
+}
+#endif // ENABLE_PROFILER
+
+char *
+BcApplication::GetFilePath(const char *FileName) const
+{
+  char *Buffer;
+
+  Buffer = new char[strlen(ApplicationPath) + strlen(FileName) + sizeof(char)];
+  if(Buffer == nullptr) { abort(); }
+
+  sprintf(Buffer, "%s%s", ApplicationPath, FileName);
+
+  return Buffer;
+}
+
 void
 BcApplication::Input(void)
 {
-  static bool LeftMouseButtonPressed = false;
+  PROFILE_ZONE(Input);
 
   Uint32 MouseState;
   int X, Y;
@@ -389,6 +556,56 @@ Error:
   return false;
 }
 
+// Keeps the replay of the last match next to the config file, so it can
+// be sent along with a bug report.
+// The whole match is written in one go, in about a millisecond, so it
+// can be done between two frames.  A finished match is not kept.
+void
+BcApplication::SaveGame(void)
+{
+  char *Buffer = GetFilePath(SaveFileName);
+
+  if(MainGame->IsMatchOver()) {
+    remove(Buffer);
+  } else {
+    MainGame->Save(Buffer);
+  }
+
+  delete[] Buffer;
+}
+
+#if ENABLE_PROFILER
+// Writes what the profiler saw, if it was ever switched on.
+void
+BcApplication::SaveProfile(void)
+{
+  char *Buffer;
+
+  if(Profiler::GetNumFrames() == 0) { return; }
+
+  Buffer = GetFilePath(ProfileFileName);
+  if(!Profiler::SaveCSV(Buffer)) {
+    std::cerr << "Error: Could not save the profile to " << Buffer << "." << std::endl;
+  }
+  delete[] Buffer;
+
+  Buffer = GetFilePath(TraceFileName);
+  if(!Profiler::SaveTrace(Buffer)) {
+    std::cerr << "Error: Could not save the profile to " << Buffer << "." << std::endl;
+  }
+  delete[] Buffer;
+}
+#endif // ENABLE_PROFILER
+
+void
+BcApplication::SaveReplay(void)
+{
+  char *Buffer = GetFilePath(ReplayFileName);
+
+  MainGame->SaveReplay(Buffer);
+  delete[] Buffer;
+}
+
 bool
 BcApplication::ValidateConfig(void)
 {
@@ -27,6 +27,7 @@ class BcApplication;
 #include <SDL2/SDL_events.h>
 
 #include "Audio.hpp"
+#include "Debug.hpp"
 #include "Game.hpp"
 #include "Menu.hpp"
 #include "Video.hpp"
@@ -39,6 +40,8 @@ private:
   Game *MainGame;
   Menu *Menus;
   Menu *NewMenu;
+  bool LeftMouseButtonPressed;
+  int AutosaveTicks;
   bool Running;
   std::minstd_rand Rand;
   char *ApplicationPath;
@@ -49,8 +52,17 @@ private:
   int SFXVolume;
   int MusicVolume;
 
+#if ENABLE_PROFILER
+  void DrawProfiler(void);
+#endif // ENABLE_PROFILER
+  char *GetFilePath(const char *FileName) const;
   void Input(void);
   bool LoadConfigFile(void);
+  void SaveGame(void);
+#if ENABLE_PROFILER
+  void SaveProfile(void);
+#endif // ENABLE_PROFILER
+  void SaveReplay(void);
   bool ValidateConfig(void);
 public:
   ~BcApplication(void);
@@ -59,6 +71,7 @@ public:
   bool ChangeFullscreenValue(const bool Value);
   void ChangeMenu(Menu *NewMenu);
   void ChangeShowGridValue(const bool Value) { ShowGrid = Value; }
+  bool ContinueGame(void);
   void EndGame(void) { if(MainGame != nullptr) { EndGame_ = true; } }
   AudioDriver *GetAudioDriver(void) { return Audio; }
   VideoDriver *GetVideoDriver(void) { return Video; }
@@ -21,49 +21,84 @@
 #include "Base.hpp"
 
 #include <cmath>
+#include <cstdlib>
 
-#include "Application.hpp"
+#include "Config.hpp"
 
-extern BcApplication *Application;
+static bool BuildEfficiencyTables(void);
+
+static double AttackEfficiencyTable[MAX_BASE_DISTANCE + 1];
+static double TransferEfficiencyTable[MAX_BASE_DISTANCE + 1];
+static const bool EfficiencyTablesBuilt = BuildEfficiencyTables();
 
 bool
 Base::AttackBase(Base *TargetBase, std::minstd_rand &Rand)
 {
   if(TargetBase == nullptr) {
-    AttackingBase = nullptr;
+    SetAttackingBase(nullptr);
 
     return true;
   }
 
   if(TargetBase->GetOwner() == this->Owner) { return false; }
-  if(this->Soldiers < 10.0)                 { return false; }
+  if(GetSoldiers() < 10.0)                  { return false; }
   if(this->TargetBase != nullptr)           { return false; }
 
-  this->AttackingBase = TargetBase;
+  SetAttackingBase(TargetBase);
+  this->AttackRate = GetAttackEfficiency(GetDistanceToBase(TargetBase));
   this->AttackRoll = (Rand() % 16) + 1;
   this->DefenseRoll = ((Rand() % 16) + 1) + TargetBase->GetDefenceValue();
 
-  Application->GetAudioDriver()->PlayAttackingSound();
-
   return true;
 }
 
+void
+Base::ChangeNeighbours(const BaseNeighbour *Neighbours, const int NumNeighbours)
+{
+  this->Neighbours = Neighbours;
+  this->NumNeighbours = NumNeighbours;
+}
+
+void
+Base::ChangeOwner(Player *Owner)
+{
+  if(this->Owner == Owner) { return; }
+
+  if(this->Owner != nullptr) { this->Owner->RemoveBase(this); }
+  this->Owner = Owner;
+  if(this->Owner != nullptr) { this->Owner->AddBase(this); }
+
+  Table->ChangeOwner(Index, (Owner != nullptr) ? Owner->GetID() : 0);
+  UpdateGrowth();
+}
+
+void
+Base::ChangeSize(const int Value)
+{
+  Table->ChangeSize(Index, Value);
+  UpdateGrowth();
+}
+
+void
+Base::ChangeSoldiers(const double Soldiers)
+{
+  Table->ChangeSoldiers(Index, Soldiers);
+}
+
 bool
 Base::ChangeTargetBase(Base *TargetBase)
 {
   if(TargetBase == nullptr) {
-    this->TargetBase = nullptr;
+    SetTargetBase(nullptr);
 
     return true;
   }
 
-  if(TargetBase->GetTargetBase() != nullptr) {
-    if(TargetBase->GetTargetBase()->GetID() == this->GetID()) { return false; }
-  }
+  if(TargetBase->GetOwner() != Owner)                 { return false; }
+  if(!Supply->CanLink(Index, TargetBase->GetIndex())) { return false; }
 
-  if(TargetBase->GetOwner() != Owner) { return false; }
-
-  this->TargetBase = TargetBase;
+  SetTargetBase(TargetBase);
+  this->TransferRate = GetTransferEfficiency(GetDistanceToBase(TargetBase));
 
   return true;
 }
@@ -76,8 +111,8 @@ Base::Colonize(Player *NewOwner, Base *SourceBase)
 
   NewOwner->ChangeScore(NewOwner->GetScore() + 1);
 
-  this->Owner = NewOwner;
-  this->Soldiers = 5.0;
+  ChangeOwner(NewOwner);
+  ChangeSoldiers(5.0);
 
   SourceBase->ChangeSoldiers(SourceBase->GetSoldiers() - 5.0);
 
@@ -88,17 +123,35 @@ void
 Base::Create(const int LocX,
              const int LocY,
              const BaseID ID,
-             const int Size, const int DefenceValue)
+             const int Size,
+             const int DefenceValue,
+             BaseTable *Table, SupplyGraph *Supply, const int Index)
 {
+  this->Table = Table;
+  this->Index = Index;
+  this->Supply = Supply;
   this->LocX = LocX;
   this->LocY = LocY;
-  this->Size = Size;
   this->ID = ID;
   this->DefenceValue = DefenceValue;
-  this->Soldiers = 0.0;
   this->AttackingBase = nullptr;
   this->TargetBase = nullptr;
   this->Owner = nullptr;
+  this->NextOwnedBase = nullptr;
+  this->PrevOwnedBase = nullptr;
+  this->IncomingAttacks = 0;
+  this->IncomingLinks = 0;
+  this->Neighbours = nullptr;
+  this->NumNeighbours = 0;
+  this->TransferRate = 0.0;
+  this->AttackRate = 0.0;
+
+  Table->ChangeSoldiers(Index, 0.0);
+  Table->ChangeSize(Index, Size);
+  Table->ChangeOwner(Index, 0);
+  Table->ChangeGrowth(Index, 0.0);
+  Table->ChangeActive(Index, false);
+  Supply->ChangeGrowth(Index, 0.0);
 }
 
 int
@@ -107,6 +160,10 @@ Base::GetDistanceToBase(const Base *TargetBase) const
   int TargetBaseLocX, TargetBaseLocY;
   int X, Y;
 
+  for(int I = 0; I < NumNeighbours; I++) {
+    if(Neighbours[I].NeighbourBase == TargetBase) { return Neighbours[I].Distance; }
+  }
+
   TargetBase->GetLoc(TargetBaseLocX, TargetBaseLocY);
 
   X = TargetBaseLocX - LocX;
@@ -118,118 +175,168 @@ Base::GetDistanceToBase(const Base *TargetBase) const
   return ceil(sqrt(Y + X));
 }
 
+const BaseNeighbour *
+Base::GetNeighbours(int &NumNeighbours) const
+{
+  NumNeighbours = this->NumNeighbours;
+
+  return Neighbours;
+}
+
+// Puts back the link and attack of a saved game as they were, without the
+// checks and dice rolls of ChangeTargetBase() and AttackBase().  Fails if
+// the link would close a loop, which no game can have made.
+bool
+Base::RestoreTargets(Base *TargetBase,
+                     Base *AttackingBase,
+                     const int AttackRoll, const int DefenseRoll)
+{
+  if(TargetBase != nullptr && !Supply->CanLink(Index, TargetBase->GetIndex())) { return false; }
+
+  SetTargetBase(TargetBase);
+  SetAttackingBase(AttackingBase);
+
+  this->AttackRoll = AttackRoll;
+  this->DefenseRoll = DefenseRoll;
+  this->TransferRate = (TargetBase != nullptr) ? GetTransferEfficiency(GetDistanceToBase(TargetBase)) : 0.0;
+  this->AttackRate = (AttackingBase != nullptr) ? GetAttackEfficiency(GetDistanceToBase(AttackingBase)) : 0.0;
+
+  return true;
+}
+
 void
-Base::Tick(const double Delta, const int DifficultyValue, std::minstd_rand &Rand)
-{
-  double AiDifficulityModifier;
-
-  switch(DifficultyValue) {
-  case 0:
-    AiDifficulityModifier = 0.5;
-    break;
-  case 1:
-    AiDifficulityModifier = 0.75;
-    break;
-  case 2:
-    AiDifficulityModifier = 1.0;
-    break;
-  case 3:
-    AiDifficulityModifier = 1.15;
-    break;
-  case 4:
-    AiDifficulityModifier = 1.3;
-    break;
-  default:
-    abort();
+Base::Tick(const double Delta, std::minstd_rand &Rand)
+{
+  // Soldier growth is done for every base at once by BaseTable::Grow(),
+  // this only runs the link and the attack.
+  if(Owner == nullptr) { return; }
+
+  if(TargetBase != nullptr) {
+    /* Check if the target base has changed owners. */
+    if(TargetBase->GetOwner() != Owner) {
+      SetTargetBase(nullptr);
+    } else {
+      const double Move = (GetSoldiers() * TransferRate) * Delta;
+
+      if(TargetBase->GetSoldiers() + Move < MAX_BASE_SOLDIERS) {
+        ChangeSoldiers(GetSoldiers() - Move);
+        TargetBase->ChangeSoldiers(TargetBase->GetSoldiers() + Move);
+      }
+    }
   }
 
-  if(Owner != nullptr) {
-    double NewSoldiers;
+  if(AttackingBase != nullptr) {
+    const double Roll = (4.0 + (double) AttackRoll) / (4.0 + (double) DefenseRoll);
 
-    if(Owner->IsHuman()) {
-      NewSoldiers = ((Delta * (double) Size) / 10.0);
-    } else {
-      NewSoldiers = ((Delta * (double) Size) / 10.0) * AiDifficulityModifier;
+    double AttackingSoldiers;
+
+    AttackingSoldiers = (GetSoldiers() * AttackRate) * Delta;
+
+    if(AttackingBase->GetOwner() == Owner) {
+      SetAttackingBase(nullptr);
+
+      return;
     }
 
-    // Yes, there is actually a limit on how many soldiers a base can hold...
-    if(this->Soldiers + NewSoldiers > 1000000000.0) {
-      Soldiers = 1000000000.0;
-    } else {
-      Soldiers += NewSoldiers;
+    if(AttackingSoldiers >= GetSoldiers() - 10.0) {
+      AttackingSoldiers = GetSoldiers() - 9.9;
     }
 
-    if(TargetBase != nullptr) {
-      /* Check if the target base has changed owners. */
-      if(TargetBase->GetOwner() != Owner) {
-        TargetBase = nullptr;
-      } else {
-        int Distance;
-        double Move;
-
-        Distance = this->GetDistanceToBase(TargetBase);
-
-        if(Distance > 6) {
-          Move = (Soldiers * (0.25 - ((0.2 / 18.0) * (double) (Distance - 6)))) * Delta;
-        } else {
-          Move = (Soldiers * 0.25) * Delta;
-        }
-
-        if(TargetBase->GetSoldiers() + Move < 1000000000.0) {
-          Soldiers -= Move;
-          TargetBase->ChangeSoldiers(TargetBase->GetSoldiers() + Move);
-        }
-      }
+    ChangeSoldiers(GetSoldiers() - AttackingSoldiers);
+    AttackingBase->ChangeSoldiers(AttackingBase->GetSoldiers() - (AttackingSoldiers * Roll));
+
+    if(AttackingBase->GetSoldiers() <= 0.0) {
+      Owner->ChangeScore(Owner->GetScore() + 3);
+
+      AttackingBase->AttackBase(nullptr, Rand);
+      AttackingBase->ChangeOwner(this->Owner);
+      AttackingBase->ChangeTargetBase(nullptr);
+      AttackingBase->ChangeSoldiers(GetSoldiers() * 0.5);
+      ChangeSoldiers(GetSoldiers() * 0.5);
+
+      SetAttackingBase(nullptr);
+    } else if(GetSoldiers() <= 10.0) {
+      AttackingBase->GetOwner()->ChangeScore(AttackingBase->GetOwner()->GetScore() + 1);
+
+      SetAttackingBase(nullptr);
     }
+  }
+}
 
-    if(AttackingBase != nullptr && this->Owner != nullptr) {
-      const double Roll = (4.0 + (double) AttackRoll) / (4.0 + (double) DefenseRoll);
+double
+GetAttackEfficiency(const int Distance)
+{
+  if(Distance >= 0 && Distance <= MAX_BASE_DISTANCE) {
+    return AttackEfficiencyTable[Distance];
+  }
 
-      double AttackingSoldiers;
-      int Distance;
+  return 1.0 - ((0.75 / 18.0) * (double) (Distance - 6));
+}
 
-      Distance = this->GetDistanceToBase(AttackingBase);
+double
+GetTransferEfficiency(const int Distance)
+{
+  if(Distance >= 0 && Distance <= MAX_BASE_DISTANCE) {
+    return TransferEfficiencyTable[Distance];
+  }
 
-      if(Distance > 6) {
-        AttackingSoldiers = (this->Soldiers * (1.0 - ((0.75 / 18.0) * (double) (Distance - 6)))) * Delta;
-      } else {
-        AttackingSoldiers = this->Soldiers * Delta;
-      }
+  return 0.25 - ((0.2 / 18.0) * (double) (Distance - 6));
+}
 
-      if(AttackingBase->GetOwner() == Owner) {
-        AttackingBase = nullptr;
+// Private Functions of Base
+void
+Base::SetAttackingBase(Base *NewAttackingBase)
+{
+  if(AttackingBase != nullptr) { AttackingBase->IncomingAttacks--; }
+  AttackingBase = NewAttackingBase;
+  if(AttackingBase != nullptr) { AttackingBase->IncomingAttacks++; }
 
-        return;
-      }
+  UpdateActive();
+}
 
-      if(AttackingSoldiers >= this->Soldiers - 10.0) {
-        AttackingSoldiers = this->Soldiers - 9.9;
-      }
+void
+Base::SetTargetBase(Base *NewTargetBase)
+{
+  if(TargetBase != nullptr) { TargetBase->IncomingLinks--; }
+  TargetBase = NewTargetBase;
+  if(TargetBase != nullptr) { TargetBase->IncomingLinks++; }
 
-      this->Soldiers -= AttackingSoldiers;
-      AttackingBase->ChangeSoldiers(AttackingBase->GetSoldiers() - (AttackingSoldiers * Roll));
+  Supply->ChangeLink(Index, (TargetBase != nullptr) ? TargetBase->Index : -1);
+  UpdateActive();
+}
 
-      if(AttackingBase->GetSoldiers() <= 0.0) {
-        Owner->ChangeScore(Owner->GetScore() + 3);
+void
+Base::UpdateActive(void)
+{
+  Table->ChangeActive(Index, (AttackingBase != nullptr || TargetBase != nullptr));
+}
 
-        AttackingBase->AttackBase(nullptr, Rand);
-        AttackingBase->ChangeOwner(this->Owner);
-        AttackingBase->ChangeTargetBase(nullptr);
-        AttackingBase->ChangeSoldiers(this->Soldiers * 0.5);
-        this->Soldiers *= 0.5;
+void
+Base::UpdateGrowth(void)
+{
+  double Growth = 0.0;
 
-        if(Application->GetGame()->GetHumanPlayer()->GetHomeBase() != nullptr) {
-          if(AttackingBase->GetID() == Application->GetGame()->GetHumanPlayer()->GetHomeBase()->GetID()) {
-            Application->GetGame()->FindNewHomeBase(Application->GetGame()->GetHumanPlayer());
-          }
-        }
+  if(Owner != nullptr) {
+    Growth = (double) GetSize() / 10.0;
+    if(!Owner->IsHuman()) { Growth *= Table->GetAIGrowthModifier(); }
+  }
 
-        AttackingBase = nullptr;
-      } else if(this->Soldiers <= 10.0) {
-        AttackingBase->GetOwner()->ChangeScore(AttackingBase->GetOwner()->GetScore() + 1);
+  Table->ChangeGrowth(Index, Growth);
+  Supply->ChangeGrowth(Index, Growth);
+}
 
-        AttackingBase = nullptr;
-      }
+static bool
+BuildEfficiencyTables(void)
+{
+  for(int Distance = 0; Distance <= MAX_BASE_DISTANCE; Distance++) {
+    if(Distance > 6) {
+      AttackEfficiencyTable[Distance] = 1.0 - ((0.75 / 18.0) * (double) (Distance - 6));
+      TransferEfficiencyTable[Distance] = 0.25 - ((0.2 / 18.0) * (double) (Distance - 6));
+    } else {
+      AttackEfficiencyTable[Distance] = 1.0;
+      TransferEfficiencyTable[Distance] = 0.25;
     }
   }
+
+  return true;
 }
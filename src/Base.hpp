@@ -22,50 +22,103 @@
 #define _BASE_HPP_
 
 class Base;
+struct BaseNeighbour;
 
 typedef unsigned int BaseID;
 
 #include <random>
 
+#include "BaseTable.hpp"
 #include "Player.hpp"
+#include "SupplyGraph.hpp"
+
+struct BaseNeighbour {
+  Base *NeighbourBase;
+  int Distance;
+  int NeighbourIndex; // Of NeighbourBase, so lists can be walked without it
+};
 
 class Base {
 private:
+  // Soldiers and size live in the table shared with the other bases.
+  BaseTable *Table;
+  int Index;
+
+  // The links of every base, kept with the TargetBase of each.
+  SupplyGraph *Supply;
+
   int LocX, LocY;
-  int Size;
   int DefenceValue;
   BaseID ID;
-  double Soldiers;
   Base *AttackingBase;
   int AttackRoll;
   int DefenseRoll;
   Base *TargetBase;
   Player *Owner;
 
+  // Links in the owner's list of bases.
+  Base *NextOwnedBase;
+  Base *PrevOwnedBase;
+
+  // How many bases are attacking or linked to this base.
+  int IncomingAttacks;
+  int IncomingLinks;
+
+  // Bases within MAX_BASE_DISTANCE, closest first.  Owned by World.
+  const BaseNeighbour *Neighbours;
+  int NumNeighbours;
+
+  // Efficiency of the current link and attack, set when they change.
+  double TransferRate;
+  double AttackRate;
+
+  void SetAttackingBase(Base *NewAttackingBase);
+  void SetTargetBase(Base *NewTargetBase);
+  void UpdateActive(void);
+  void UpdateGrowth(void);
 public:
   ~Base(void) { }
   Base(void) { }
   bool AttackBase(Base *TargetBase, std::minstd_rand &Rand);
-  void ChangeOwner(Player *Owner) { this->Owner = Owner; }
-  void ChangeSize(const int Value) { this->Size = Value; }
-  void ChangeSoldiers(const double Soldiers) { this->Soldiers = Soldiers; }
+  void ChangeNextOwnedBase(Base *NextOwnedBase) { this->NextOwnedBase = NextOwnedBase; }
+  void ChangeOwner(Player *Owner);
+  void ChangePrevOwnedBase(Base *PrevOwnedBase) { this->PrevOwnedBase = PrevOwnedBase; }
+  void ChangeSize(const int Value);
+  void ChangeSoldiers(const double Soldiers);
+  void ChangeNeighbours(const BaseNeighbour *Neighbours, const int NumNeighbours);
   bool ChangeTargetBase(Base *TargetBase);
   bool Colonize(Player *Owner, Base *SourceBase);
   void Create(const int LocX,
               const int LocY,
               const BaseID ID,
-              const int Size, const int DefenceValue);
+              const int Size,
+              const int DefenceValue,
+              BaseTable *Table, SupplyGraph *Supply, const int Index);
   Base *GetAttackingBase(void) const { return AttackingBase; }
   int GetDefenceValue(void) const { return DefenceValue; }
   int GetDistanceToBase(const Base *TargetBase) const;
   BaseID GetID(void) const { return ID; }
+  int GetAttackRoll(void) const { return AttackRoll; }
+  int GetDefenseRoll(void) const { return DefenseRoll; }
+  int GetIndex(void) const { return Index; }
+  int GetIncomingAttacks(void) const { return IncomingAttacks; }
+  int GetIncomingLinks(void) const { return IncomingLinks; }
   void GetLoc(int &X, int &Y) const { X = LocX; Y = LocY; }
+  const BaseNeighbour *GetNeighbours(int &NumNeighbours) const;
+  Base *GetNextOwnedBase(void) const { return NextOwnedBase; }
   Player *GetOwner(void) const { return Owner; }
-  int GetSize(void) const { return Size; }
-  double GetSoldiers(void) const { return Soldiers; }
+  Base *GetPrevOwnedBase(void) const { return PrevOwnedBase; }
+  int GetSize(void) const { return Table->GetSize(Index); }
+  double GetSoldiers(void) const { return Table->GetSoldiers(Index); }
   Base *GetTargetBase(void) const { return TargetBase; }
   bool IsAttacking(void) const { return (AttackingBase != nullptr) ? true : false; }
-  void Tick(const double Tick, const int DifficultyValue, std::minstd_rand &Rand);
+  bool RestoreTargets(Base *TargetBase,
+                      Base *AttackingBase,
+                      const int AttackRoll, const int DefenseRoll);
+  void Tick(const double Tick, std::minstd_rand &Rand);
 };
 
+double GetAttackEfficiency(const int Distance);
+double GetTransferEfficiency(const int Distance);
+
 #endif /* _BASE_HPP_ */
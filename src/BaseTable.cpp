@@ -0,0 +1,134 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "BaseTable.hpp"
+
+#include "Config.hpp"
+
+static int CountTrailingZeros(uint64_t Bits);
+
+BaseTable::BaseTable(void)
+{
+  NumBases = 0;
+  AIGrowthModifier = 1.0;
+  Soldiers = nullptr;
+  Growth = nullptr;
+  Size = nullptr;
+  Owner = nullptr;
+  Active = nullptr;
+}
+
+BaseTable::~BaseTable(void)
+{
+  delete[] Soldiers;
+  delete[] Growth;
+  delete[] Size;
+  delete[] Owner;
+  delete[] Active;
+}
+
+void
+BaseTable::ChangeActive(const int Index, const bool IsActive)
+{
+  const uint64_t Bit = (uint64_t) 1 << (Index % 64);
+
+  if(IsActive) {
+    Active[Index / 64] |= Bit;
+  } else {
+    Active[Index / 64] &= ~Bit;
+  }
+}
+
+bool
+BaseTable::Create(const int NumBases)
+{
+  const int NumActiveWords = (NumBases + 63) / 64;
+
+  this->NumBases = NumBases;
+
+  Soldiers = new double[NumBases];
+  Growth = new double[NumBases];
+  Size = new int[NumBases];
+  Owner = new unsigned int[NumBases];
+  Active = new uint64_t[NumActiveWords];
+  if(Soldiers == nullptr || Growth == nullptr ||
+     Size == nullptr || Owner == nullptr || Active == nullptr) {
+    return false;
+  }
+
+  for(int I = 0; I < NumBases; I++) {
+    Soldiers[I] = 0.0;
+    Growth[I] = 0.0;
+    Size[I] = 0;
+    Owner[I] = 0;
+  }
+
+  for(int I = 0; I < NumActiveWords; I++) { Active[I] = 0; }
+
+  return true;
+}
+
+int
+BaseTable::GetNextActive(const int Index) const
+{
+  int Word = Index / 64;
+  uint64_t Bits;
+
+  if(Index >= NumBases) { return -1; }
+
+  // Skip the bits of the first word below Index.
+  Bits = Active[Word] & (~(uint64_t) 0 << (Index % 64));
+  for(;;) {
+    if(Bits != 0) { return (Word * 64) + CountTrailingZeros(Bits); }
+
+    if(++Word >= (NumBases + 63) / 64) { return -1; }
+    Bits = Active[Word];
+  }
+}
+
+void
+BaseTable::Grow(const double Delta)
+{
+  // Kept free of branches and calls so the compiler can vectorise it.
+  for(int I = 0; I < NumBases; I++) {
+    const double NewSoldiers = Soldiers[I] + (Growth[I] * Delta);
+
+    // Yes, there is actually a limit on how many soldiers a base can hold...
+    Soldiers[I] = (NewSoldiers > MAX_BASE_SOLDIERS) ? MAX_BASE_SOLDIERS : NewSoldiers;
+  }
+}
+
+// Private Functions of BaseTable
+static int
+CountTrailingZeros(uint64_t Bits)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll(Bits);
+#else
+  int Count = 0;
+
+  while(!(Bits & 1)) {
+    Bits >>= 1;
+    Count++;
+  }
+
+  return Count;
+#endif
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _BASETABLE_HPP_
+#define _BASETABLE_HPP_
+
+class BaseTable;
+
+#include <cstdint>
+
+// The per-base state touched every tick, kept in parallel arrays indexed
+// by the base number so the soldier growth of all bases is one loop.
+class BaseTable {
+private:
+  int NumBases;
+  double AIGrowthModifier;
+
+  double *Soldiers;
+  double *Growth;      // Soldiers gained per second, zero when unowned
+  int *Size;
+  unsigned int *Owner; // Zero when unowned, otherwise the PlayerID
+
+  // One bit per base with a link or an attack to run.
+  uint64_t *Active;
+public:
+  BaseTable(void);
+  ~BaseTable(void);
+  void ChangeActive(const int Index, const bool IsActive);
+  void ChangeAIGrowthModifier(const double Modifier) { AIGrowthModifier = Modifier; }
+  void ChangeGrowth(const int Index, const double Value) { Growth[Index] = Value; }
+  void ChangeOwner(const int Index, const unsigned int Value) { Owner[Index] = Value; }
+  void ChangeSize(const int Index, const int Value) { Size[Index] = Value; }
+  void ChangeSoldiers(const int Index, const double Value) { Soldiers[Index] = Value; }
+  bool Create(const int NumBases);
+  double GetAIGrowthModifier(void) const { return AIGrowthModifier; }
+  double GetGrowth(const int Index) const { return Growth[Index]; }
+  int GetNextActive(const int Index) const;
+  int GetNumBases(void) const { return NumBases; }
+  unsigned int GetOwner(const int Index) const { return Owner[Index]; }
+  int GetSize(const int Index) const { return Size[Index]; }
+  double GetSoldiers(const int Index) const { return Soldiers[Index]; }
+  void Grow(const double Delta);
+};
+
+#endif // _BASETABLE_HPP_
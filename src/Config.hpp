@@ -26,22 +26,44 @@
 #define AI_CHANCE_TO_ATTACK      20 // (1/20) Chance
 #define AI_CHANCE_TO_COLONIZE    4  // (1/4)  Chance
 #define AI_CHANCE_TO_UNLINK_BASE 2  // (1/2)  Chance
+#define AI_PLAN_TIME             0.25 // Seconds from a decision to carrying it out
+#define AI_THREADS               0  // Threads the AIs plan on in a game, 0 for one per core
+#define AI_ATTACK_MARGIN         1.25 // Expected damage over defenders the Utility planner wants
+#define AI_ROLLOUT_MOVES         16 // Attacks the MonteCarlo planner plays out a decision
+#define AI_ROLLOUTS              8  // Play-outs of each attack, each with its own rolls
+#define AI_ROLLOUT_TIME          8.0  // Seconds of game time a play-out runs for
+#define AI_ROLLOUT_STEP          0.25 // Seconds of game time a play-out step runs for
+#define AI_ROLLOUT_BASE_VALUE    60.0 // Seconds of its growth a base is worth in a play-out
 
 // World Generation Configurations
 #define WORLDGEN_CHANCE_FOR_FOREST_TILE 4 // (1/4) Chance
-#define NUMBER_OF_BASES 64                // Must be 2**N
-#define NUMBER_OF_MAPGEN_ITERATIONS 1024  // Must be 2**N
-#define WORLD_SIZE_X 96                   // Must be 2**N
-#define WORLD_SIZE_Y 96                   // Must be 2**N
+#define NUMBER_OF_BASES 64                // Default, at least three per player
+#define WORLDGEN_CHUNK_SIZE 48            // Tiles along each side of a generated chunk
+#define WORLDGEN_TILES_PER_STAMP 9        // Tiles per diamond-square stamp
+#define WORLD_SIZE_X 96                   // Default, from 32 to 65536
+#define WORLD_SIZE_Y 96                   // Default, from 32 to 65536
 
 // Game Configurations
-#define NUMBER_OF_PLAYERS 4
+#define NUMBER_OF_PLAYERS 4 // Default
+#define MAX_PLAYERS 64      // Most players a world can be shared out between
+#define MAX_BASE_DISTANCE 24 // How far a base can link, attack or colonize
+#define MAX_BASE_SOLDIERS 1000000000.0
+#define SUPPLY_FLOW_SCALE 4294967296.0 // Fixed point steps of a soldier a second in a supply flow
+#define SIMULATION_TICK_RATE 60 // Simulation ticks per second
+#define MAX_SIMULATION_STEPS 8  // Most ticks run in one frame to catch up
+#define REPLAY_HASH_INTERVAL 60 // Ticks between state hashes in a replay
+#define REPLAY_MAX_TIME 86400   // Most seconds of game time a replay can hold
+#define AUTOSAVE_INTERVAL 60    // Seconds of game time between autosaves
+#define IDLE_WAIT_TIME 100      // Most ms to wait for input while nothing changes
 
 // Graphics Configurations
 #define TILE_SIZE 64   // Must be 2**N
+#define TERRAIN_CHUNK_SIZE 16 // Tiles along each side of a cached terrain chunk
+#define TERRAIN_CACHE_SIZE 24 // Most terrain chunks kept as textures at once
 
 #define FONT_WIDTH 8
 #define FONT_HEIGHT 12
+#define TEXT_CACHE_SIZE 256 // Strings kept laid out before unused ones are dropped
 
 #define WINDOW_WIDTH 1366
 #define WINDOW_HEIGHT 768
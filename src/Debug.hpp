@@ -26,4 +26,6 @@
 #define DEBUG_GUI 0
 #define DEBUG_INPUT 0
 
+#define ENABLE_PROFILER 1 // 0 compiles out PROFILE_ZONE() and the F3 profiler
+
 #endif // _DEBUG_HPP_
@@ -20,6 +20,7 @@
 
 #include "Game.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -39,6 +40,7 @@
 #include "GameOptionWindow.hpp"
 #include "GameOverWindow.hpp"
 #include "Label.hpp"
+#include "Profiler.hpp"
 #include "QuitGameWindow.hpp"
 #include "ScoreWindow.hpp"
 #include "VictoryWindow.hpp"
@@ -53,11 +55,18 @@ const char *PlayerNames[] = {
   "Gen. Destruction"
 };
 
-extern BcApplication *Application;
+// The board has a name and a colour for this many players.
+#define MAX_GAME_PLAYERS ((int) (sizeof(PlayerNames) / sizeof(PlayerNames[0])))
+
+static int FloorDiv(const int Value, const int Divisor);
+static void PlayAttackingSound(Simulation *MainSimulation, AudioDriver *Audio);
 
 Game::~Game(void)
 {
-  delete GameWorld;
+  // The simulation waits for the AI plans on the pool before it goes.
+  delete MainSimulation;
+  delete Recording;
+  delete AIPool;
 
   if(NewWindow != nullptr)  { delete NewWindow; }
   if(MainWindow != nullptr) { delete MainWindow; }
@@ -80,7 +89,10 @@ Game::CloseWindow(void)
 void
 Game::Draw(VideoDriver *Video)
 {
-  GameWorld->Draw(Video, Offset_X, Offset_Y, ShowGrid);
+  PROFILE_ZONE(Draw);
+
+  UpdateViewArea(Video);
+  DrawWorld(Video);
 
   DrawOwnerHighlights(Video);
   DrawSelectedBase(Video);
@@ -89,78 +101,62 @@ Game::Draw(VideoDriver *Video)
   DrawAttacks(Video);
   DrawBaseStatus(Video);
 
-  if(MainWindow) { MainWindow->Draw(Video, 0, 0); }
-}
-
-void
-Game::FindNewHomeBase(Player *TargetPlayer)
-{
-  Base *LargestBase = nullptr;
+  if(MainWindow) {
+    PROFILE_ZONE(DrawWindow);
 
-  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
-    Base *TargetBase = GameWorld->GetBase(I);
-
-    if(TargetBase->GetOwner() != nullptr) {
-      if(TargetBase->GetOwner()->GetID() == TargetPlayer->GetID()) {
-        if(LargestBase == nullptr) {
-          LargestBase = TargetBase;
-        } else if(LargestBase->GetSize() < TargetBase->GetSize()) {
-          LargestBase = TargetBase;
-        }
-      }
-    }
+    MainWindow->Draw(Video, 0, 0);
   }
-
-  TargetPlayer->ChangeHomeBase(LargestBase);
-}
-
-Player *
-Game::GetPlayer(const int I)
-{
-  if(I < 0 || I >= NUMBER_OF_PLAYERS) { return nullptr; }
-
-  return &Players[I];
 }
 
 bool
-Game::Init(const int DifficultyValue,
-           VideoDriver *Video, std::minstd_rand &Rand)
+Game::Init(const WorldSettings &Settings,
+           const int DifficultyValue,
+           VideoDriver *Video,
+           AudioDriver *Audio, std::minstd_rand &Rand)
 {
-  this->DifficultyValue = DifficultyValue;
+  this->Audio = Audio;
   this->NewWindow = nullptr;
   this->MainWindow = nullptr;
+  this->AIPool = nullptr;
 
-  GameWorld = new World();
+  const unsigned int Seed = (unsigned int) Rand();
 
-  GameWorld->Create(WORLD_SIZE_X, WORLD_SIZE_Y, NUMBER_OF_BASES, Rand);
+  if(Settings.NumPlayers > MAX_GAME_PLAYERS) { return false; }
 
-  CreatePlayers();
-  AssignPlayerBases(Rand);
+  MainSimulation = new Simulation();
+  Recording = new Replay();
 
-  this->ShowGrid = false;
-  this->CloseMainWindow = false;
-  this->Offset_X = 0;
-  this->Offset_Y = 0;
-  this->Mouse_OldLocX = 0;
-  this->Mouse_OldLocY = 0;
-  this->EndGameTick = 0.0;
+  if(!MainSimulation->Create(Settings, DifficultyValue, true, Seed, nullptr) ||
+     !Recording->Create(Settings, Seed, DifficultyValue, true,
+                        SIMULATION_TICK_RATE, REPLAY_HASH_INTERVAL, nullptr)) {
+    delete MainSimulation;
+    delete Recording;
 
-  CenterOnBase(Video, HumanPlayer->GetHomeBase());
+    MainSimulation = nullptr;
+    Recording = nullptr;
+
+    return false;
+  }
+
+  MainSimulation->ChangeRecorder(Recording);
+  Setup(Video);
 
   return true;
 }
 
 void
-Game::Input(SDL_Event *Event,
-            VideoDriver *Video, std::minstd_rand &Rand)
+Game::Input(SDL_Event *Event, VideoDriver *Video)
 {
-  static int Mouse_OldLocX = 0, Mouse_OldLocY = 0;
-  static bool LeftMouseButtonPressed = false;
-  static bool RightMouseButtonPressed = false;
+  PROFILE_ZONE(Input);
 
   Uint32 State;
   int X, Y;
 
+  // What was drawn into the terrain textures is gone.
+  if(Event->type == SDL_RENDER_TARGETS_RESET || Event->type == SDL_RENDER_DEVICE_RESET) {
+    Terrain.Clear();
+  }
+
   State = SDL_GetMouseState(&X, &Y);
 
   if(MainWindow != nullptr) {
@@ -179,30 +175,47 @@ Game::Input(SDL_Event *Event,
 
   if(State & SDL_BUTTON(SDL_BUTTON_RIGHT)) {
     if(!RightMouseButtonPressed) {
-      SelectedTileInput(X, Y, Rand);
+      SelectedTileInput(X, Y);
       RightMouseButtonPressed = true;
     }
   } else {
     RightMouseButtonPressed = false;
   }
 
-  const Uint8 *KeyboardState = SDL_GetKeyboardState(nullptr);
-  if(KeyboardState[SDL_SCANCODE_G]) {
-    if(!ShowGrid) {
-      ShowGrid = true;
-    } else {
-      ShowGrid = false;
-    }
-  }
-
-  if(KeyboardState[SDL_SCANCODE_A]) { FindNearbyEnemyBase(Video, HumanPlayer); }
-  if(KeyboardState[SDL_SCANCODE_S]) { CenterOnBase(Video, HumanPlayer->GetHomeBase()); }
-  if(KeyboardState[SDL_SCANCODE_F]) { DestroyLink(); }
-  if(KeyboardState[SDL_SCANCODE_W]) { HumanPlayer->ChangeSelectedBase(nullptr); }
-  if(KeyboardState[SDL_SCANCODE_ESCAPE]) { CreateExitWindow(this, Video); }
-  if(KeyboardState[SDL_SCANCODE_F1]) { CreateScoreWindow(this, Video); }
-
   switch(Event->type) {
+  case SDL_KEYDOWN:
+    // Hotkeys act once per press, not for as long as they are held.
+    if(Event->key.repeat) { break; }
+
+    switch(Event->key.keysym.scancode) {
+    case SDL_SCANCODE_G:
+      ShowGrid = !ShowGrid;
+      break;
+    case SDL_SCANCODE_A:
+      FindNearbyEnemyBase(Video, HumanPlayer);
+      break;
+    case SDL_SCANCODE_S:
+      CenterOnBase(Video, HumanPlayer->GetHomeBase());
+      break;
+    case SDL_SCANCODE_F:
+      DestroyLink();
+      break;
+    case SDL_SCANCODE_R:
+      RouteToBase();
+      break;
+    case SDL_SCANCODE_W:
+      HumanPlayer->ChangeSelectedBase(nullptr);
+      break;
+    case SDL_SCANCODE_ESCAPE:
+      CreateExitWindow(this, Video);
+      break;
+    case SDL_SCANCODE_F1:
+      CreateScoreWindow(this, Video);
+      break;
+    default:
+      break;
+    }
+    break;
   case SDL_MOUSEMOTION:
     State = SDL_GetMouseState(&X, &Y);
     if(State & SDL_BUTTON(SDL_BUTTON_LEFT)) {
@@ -222,104 +235,92 @@ Game::Input(SDL_Event *Event,
   }
 }
 
-void
-Game::Tick(const double Delta, VideoDriver *Video, std::minstd_rand &Rand)
+bool
+Game::IsMatchOver(void)
 {
-  CheckMusic(Rand);
-  CheckToCloseWindow();
+  return !HumanPlayer->IsAlive() || MainSimulation->GetWinner() != nullptr;
+}
+
+// Carries on a game saved with Save().  There is no replay of it, as the
+// replay can only start from the beginning of a match.
+bool
+Game::Load(const char *FileName, VideoDriver *Video, AudioDriver *Audio)
+{
+  this->Audio = Audio;
+  this->NewWindow = nullptr;
+  this->MainWindow = nullptr;
+  this->Recording = nullptr;
+  this->AIPool = nullptr;
 
-  if(CloseMainWindow) {
-    delete MainWindow;
+  MainSimulation = new Simulation();
 
-    MainWindow = nullptr;
-    CloseMainWindow = false;
-  }
+  if(!MainSimulation->Load(FileName) || MainSimulation->GetHumanPlayer() == nullptr ||
+     MainSimulation->GetNumPlayers() > MAX_GAME_PLAYERS) {
+    delete MainSimulation;
 
-  if(NewWindow != nullptr) {
-    if(MainWindow != nullptr) { delete MainWindow; }
+    MainSimulation = nullptr;
 
-    MainWindow = NewWindow;
-    NewWindow = nullptr;
+    return false;
   }
 
-  if(MainWindow != nullptr) { return; }
+  Setup(Video);
 
-  BasesTick(Delta, Rand);
-  PlayersTick(Delta, Rand);
-  CheckIfPlayersAreAlive();
-  CheckIfHumanPlayerIsAlive(Delta, Video);
-  CheckIfAIPlayersAreAlive(Delta, Video);
+  return true;
 }
 
-/* Private Functions of Game */
-void
-Game::AssignPlayerBases(std::minstd_rand &Rand)
+bool
+Game::Save(const char *FileName)
 {
-  Player *PlayersToAssignBases[NUMBER_OF_PLAYERS];
+  return MainSimulation->Save(FileName);
+}
 
-  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) {
-  AssignAgain:
-    PlayersToAssignBases[I] = &Players[Rand() % NUMBER_OF_PLAYERS];
+// Ends the recording of the match and writes it out, so a match can be
+// played again with the headless build.
+bool
+Game::SaveReplay(const char *FileName)
+{
+  if(Recording == nullptr) { return false; }
 
-    for(int J = 0; J < I; J++) {
-      if(PlayersToAssignBases[J]->GetID() == PlayersToAssignBases[I]->GetID()) {
-        goto AssignAgain;
-      }
-    }
-  }
+  Recording->Finish(MainSimulation->GetTickCount(), MainSimulation->GetStateHash());
 
-  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) {
-    Base *TargetBase = GameWorld->GetBase((I * (NUMBER_OF_BASES / 4)) + (Rand() % (NUMBER_OF_BASES / 4)));
+  return Recording->Save(FileName);
+}
 
-    if(TargetBase->GetOwner() != nullptr) { abort(); }
+// Returns false if nothing on screen changed, as while a window is open
+// the game is paused.
+bool
+Game::Tick(const double Delta, VideoDriver *Video, std::minstd_rand &Rand)
+{
+  PROFILE_ZONE(Tick);
 
-    TargetBase->ChangeOwner(PlayersToAssignBases[I]);
-    if(TargetBase->GetSize() < 5) {
-      TargetBase->ChangeSize(5); // Give the player a fighting chance.
-    }
+  bool Changed = false;
 
-    TargetBase->ChangeSoldiers(10.0);
+  CheckMusic(Rand);
+  if(CheckToCloseWindow()) { Changed = true; }
 
-    if(PlayersToAssignBases[I]->IsHuman()) {
-      PlayersToAssignBases[I]->ChangeHomeBase(TargetBase);
-    }
+  if(NewWindow != nullptr) {
+    if(MainWindow != nullptr) { delete MainWindow; }
+
+    MainWindow = NewWindow;
+    NewWindow = nullptr;
+    Changed = true;
   }
-}
 
-void
-Game::AttackBase(Base *SrcBase, Base *TargetBase, std::minstd_rand &Rand)
-{
-  if(SrcBase->GetAttackingBase() != nullptr) {
-    if(SrcBase->GetAttackingBase()->GetID() == TargetBase->GetID()) {
-      const int Score = TargetBase->GetOwner()->GetScore();
+  if(MainWindow != nullptr) { return Changed; }
 
-      TargetBase->GetOwner()->ChangeScore(Score + 1);
-      SrcBase->AttackBase(nullptr, Rand);
-    } else {
-      SrcBase->AttackBase(TargetBase, Rand);
-    }
-  } else {
-    SrcBase->AttackBase(TargetBase, Rand);
-  }
+  MainSimulation->Tick(Delta);
+  CheckSelectedBase();
+  CheckIfHumanPlayerIsAlive(Delta, Video);
+  CheckIfAIPlayersAreAlive(Delta, Video);
+
+  return true;
 }
 
+/* Private Functions of Game */
 void
-Game::BasesTick(const double Delta, std::minstd_rand &Rand)
+Game::AttackBase(Base *SrcBase, Base *TargetBase)
 {
-  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
-    Base *TargetBase = GameWorld->GetBase(I);
-
-    TargetBase->Tick(Delta, this->DifficultyValue, Rand);
-
-    /* Check if the human player has a base selected that has been conquered by
-       a computer player, and if so, then unselected it if the base has been
-       conquered by a computer player. */
-    if(HumanPlayer->GetSelectedBase() != nullptr) {
-      if(HumanPlayer->GetSelectedBase()->GetOwner()->GetID() != HumanPlayer->GetID()) {
-        HumanPlayer->ChangeSelectedBase(nullptr);
-      }
-    }
-  }
+  RunCommand(CommandType::Attack, SrcBase, TargetBase);
 }
 
 void
@@ -345,7 +346,7 @@ Game::CenterOnBase(VideoDriver *Video, const Base *TargetBase)
 void
 Game::CheckIfAIPlayersAreAlive(const double Delta, VideoDriver *Video)
 {
-  if(!Players[1].IsAlive() && !Players[2].IsAlive() && !Players[3].IsAlive()) {
+  if(MainSimulation->GetWinner() == HumanPlayer) {
     // If not, then a human victory over the AI overlords.
     if(EndGameTick >= 3.0) {
       VictoryWindow(this, Video);
@@ -368,28 +369,6 @@ Game::CheckIfHumanPlayerIsAlive(const double Delta, VideoDriver *Video)
   }
 }
 
-void
-Game::CheckIfPlayersAreAlive(void)
-{
-  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) {
-    Player *TargetPlayer = &Players[I];
-
-    for(int J = 0; J < GameWorld->GetNumBases(); J++) {
-      Base *TargetBase = GameWorld->GetBase(J);
-
-      if(TargetBase->GetOwner() != nullptr) {
-        if(TargetBase->GetOwner()->GetID() == TargetPlayer->GetID()) {
-          goto IsAlive;
-        }
-      }
-    }
-
-    TargetPlayer->Dead();
-  IsAlive:
-    continue;
-  }
-}
-
 void
 Game::CheckMapBoarder(VideoDriver *Video, const int X, const int Y)
 {
@@ -426,47 +405,49 @@ Game::CheckMusic(std::minstd_rand &Rand)
   if(MainWindow != nullptr) {
     if(MainWindow->GetName() != GameOverWindowName &&
        MainWindow->GetName() != VictoryWindowName &&
-       !Application->GetAudioDriver()->IsMusicPlaying()) {
+       !Audio->IsMusicPlaying()) {
       if(Rand() % 2) {
-        Application->GetAudioDriver()->PlayMusic(SONG_THE_COMING_WAR);
+        Audio->PlayMusic(SONG_THE_COMING_WAR);
       } else {
-        Application->GetAudioDriver()->PlayMusic(SONG_THE_ROAD_TO_VICTORY);
+        Audio->PlayMusic(SONG_THE_ROAD_TO_VICTORY);
       }
     }
   } else {
-    if(!Application->GetAudioDriver()->IsMusicPlaying()) {
+    if(!Audio->IsMusicPlaying()) {
       if(Rand() % 2) {
-        Application->GetAudioDriver()->PlayMusic(SONG_THE_COMING_WAR);
+        Audio->PlayMusic(SONG_THE_COMING_WAR);
       } else {
-        Application->GetAudioDriver()->PlayMusic(SONG_THE_ROAD_TO_VICTORY);
+        Audio->PlayMusic(SONG_THE_ROAD_TO_VICTORY);
       }
     }
   }
 }
 
 void
-Game::CheckToCloseWindow(void)
+Game::CheckSelectedBase(void)
 {
-  if(CloseMainWindow) {
-    if(MainWindow != nullptr) { delete MainWindow; }
-
-    MainWindow = nullptr;
-    CloseMainWindow = false;
+  /* Check if the human player has a base selected that has been conquered by
+     a computer player, and if so, then unselected it if the base has been
+     conquered by a computer player. */
+  if(HumanPlayer->GetSelectedBase() != nullptr) {
+    if(HumanPlayer->GetSelectedBase()->GetOwner()->GetID() != HumanPlayer->GetID()) {
+      HumanPlayer->ChangeSelectedBase(nullptr);
+    }
   }
 }
 
-void
-Game::CreatePlayers(void)
+// Returns true if the window was closed.
+bool
+Game::CheckToCloseWindow(void)
 {
-  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) {
-    if(I == 0) {
-      Players[I].Create(I + 1, true);
-    } else {
-      Players[I].Create(I + 1, false);
-    }
-  }
+  if(!CloseMainWindow) { return false; }
+
+  if(MainWindow != nullptr) { delete MainWindow; }
+
+  MainWindow = nullptr;
+  CloseMainWindow = false;
 
-  HumanPlayer = &Players[0];
+  return true;
 }
 
 void
@@ -475,19 +456,17 @@ Game::ColonizeBase(Base *TargetBase, Player *TargetPlayer)
   Base *SelectedBase = TargetPlayer->GetSelectedBase();
 
   if(SelectedBase != nullptr) {
-    const int Distance = SelectedBase->GetDistanceToBase(TargetBase);
-
-    if(SelectedBase->GetSoldiers() > 10.0 && Distance <= 24) {
-      TargetBase->Colonize(TargetPlayer, SelectedBase);
-    }
+    RunCommand(CommandType::Colonize, SelectedBase, TargetBase);
   }
 }
 
 void
 Game::DrawAttacks(VideoDriver *Video)
 {
-  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
-    Base *TargetBase = GameWorld->GetBase(I);
+  PROFILE_ZONE(DrawAttacks);
+
+  for(size_t I = 0; I < ViewLinkBases.size(); I++) {
+    Base *TargetBase = ViewLinkBases[I];
 
     if(TargetBase->GetAttackingBase() != nullptr) {
       Base *AttackingBase = TargetBase->GetAttackingBase();
@@ -508,6 +487,8 @@ Game::DrawAttacks(VideoDriver *Video)
       EndPixelX += TILE_SIZE / 2;
       EndPixelY += (TILE_SIZE / 2) + (TILE_SIZE / 4);
 
+      if(!IsLineInView(StartPixelX, StartPixelY, EndPixelX, EndPixelY)) { continue; }
+
       Video->DrawLine(StartPixelX, StartPixelY,
                       EndPixelX, EndPixelY,
                       0xFF, 0x00, 0x00, 0xFF);
@@ -520,13 +501,16 @@ void
 Game::DestroyLink(void)
 {
   if(HumanPlayer->GetSelectedBase() != nullptr) {
-    HumanPlayer->GetSelectedBase()->ChangeTargetBase(nullptr);
+    RunCommand(CommandType::Unlink, HumanPlayer->GetSelectedBase(), nullptr);
   }
 }
 
 void
 Game::DrawBaseStatus(VideoDriver *Video)
 {
+  PROFILE_ZONE(DrawBaseStatus);
+
+  Base *TargetBase;
   int TileX, TileY;
   int X, Y;
 
@@ -535,31 +519,21 @@ Game::DrawBaseStatus(VideoDriver *Video)
   SDL_GetMouseState(&X, &Y);
   GetMousePointerTileLoc(X, Y, TileX, TileY);
 
-  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
-    Base *TargetBase = GameWorld->GetBase(I);
-    int LocX, LocY;
-
-    TargetBase->GetLoc(LocX, LocY);
+  TargetBase = GameWorld->GetBaseByLoc(TileX, TileY);
+  if(TargetBase == nullptr) { return; }
 
-    /* If the player is the owner of this base, then highlight the soldiers
-       and size of the base. */
-    if(LocX == (int) TileX &&
-       LocY == (int) TileY &&
-       TargetBase->GetOwner() == HumanPlayer) {
-      DrawBaseStatusOwner(Video, TargetBase);
-    /* If the player is not the owner and not any other players of this base,
-       then highlight that it is not captured. */
-    } else if(LocX == (int) TileX &&
-              LocY == (int) TileY &&
-              TargetBase->GetOwner() == nullptr) {
-      DrawBaseStatusUnowned(Video, TargetBase);
-    /* If an other player owns this base, then
-       highlight the base owner name. */
-    } else if(LocX == (int) TileX &&
-              LocY == (int) TileY &&
-              TargetBase->GetOwner() != HumanPlayer) {
-      DrawBaseStatusEnemy(Video, TargetBase);
-    }
+  /* If the player is the owner of this base, then highlight the soldiers
+     and size of the base. */
+  if(TargetBase->GetOwner() == HumanPlayer) {
+    DrawBaseStatusOwner(Video, TargetBase);
+  /* If the player is not the owner and not any other players of this base,
+     then highlight that it is not captured. */
+  } else if(TargetBase->GetOwner() == nullptr) {
+    DrawBaseStatusUnowned(Video, TargetBase);
+  /* If an other player owns this base, then
+     highlight the base owner name. */
+  } else {
+    DrawBaseStatusEnemy(Video, TargetBase);
   }
 }
 
@@ -597,18 +571,14 @@ Game::DrawBaseStatusEnemy(VideoDriver *Video, const Base *TargetBase)
 
   if(HumanPlayer->GetSelectedBase() != nullptr &&
      TargetBase != HumanPlayer->GetSelectedBase()) {
-    double Distance;
+    int Distance;
 
     Distance = HumanPlayer->GetSelectedBase()->GetDistanceToBase(TargetBase);
 
-    if(Distance <= 24) {
+    if(Distance <= MAX_BASE_DISTANCE) {
       int AttackingPercentage;
 
-      if(Distance > 6) {
-        AttackingPercentage = (1.0 - ((0.75 / 18.0) * (double) (Distance - 6))) * 100.0;
-      } else {
-        AttackingPercentage = 100;
-      }
+      AttackingPercentage = GetAttackEfficiency(Distance) * 100.0;
 
       sprintf(Buffer2, "Distance: %d (%d%%)", (int) Distance, AttackingPercentage);
     } else {
@@ -687,18 +657,14 @@ Game::DrawBaseStatusOwner(VideoDriver *Video, const Base *TargetBase)
 
   if(HumanPlayer->GetSelectedBase() != nullptr &&
      TargetBase != HumanPlayer->GetSelectedBase()) {
-    double Distance;
+    int Distance;
 
     Distance = HumanPlayer->GetSelectedBase()->GetDistanceToBase(TargetBase);
 
-    if(Distance <= 24) {
+    if(Distance <= MAX_BASE_DISTANCE) {
       int MovingPercentage;
 
-      if(Distance > 6) {
-        MovingPercentage = ceil((0.25 - ((0.20 / 18.0) * (double) (Distance - 6))) * 100.0);
-      } else {
-        MovingPercentage = 25;
-      }
+      MovingPercentage = ceil(GetTransferEfficiency(Distance) * 100.0);
 
       sprintf(Buffer3, "Distance: %d (%d%%)", (int) Distance, MovingPercentage);
     } else {
@@ -790,7 +756,7 @@ Game::DrawBaseStatusUnowned(VideoDriver *Video, const Base *TargetBase)
 
     Distance = HumanPlayer->GetSelectedBase()->GetDistanceToBase(TargetBase);
 
-    if(Distance <= 24) {
+    if(Distance <= MAX_BASE_DISTANCE) {
       sprintf(Buffer2, "Distance: %d", (int) Distance);
     } else {
       sprintf(Buffer2, "Distance: %d (Too Far)", (int) Distance);
@@ -846,6 +812,8 @@ Game::DrawBaseStatusUnowned(VideoDriver *Video, const Base *TargetBase)
 void
 Game::DrawHighlight(VideoDriver *Video)
 {
+  PROFILE_ZONE(DrawHighlight);
+
   int X, Y;
   int TileX, TileY;
 
@@ -860,8 +828,10 @@ Game::DrawHighlight(VideoDriver *Video)
 void
 Game::DrawLinks(VideoDriver *Video)
 {
-  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
-    Base *TargetBase = GameWorld->GetBase(I);
+  PROFILE_ZONE(DrawLinks);
+
+  for(size_t I = 0; I < ViewLinkBases.size(); I++) {
+    Base *TargetBase = ViewLinkBases[I];
 
     if(TargetBase->GetTargetBase() != nullptr) {
       Player *Owner = TargetBase->GetOwner();
@@ -883,6 +853,8 @@ Game::DrawLinks(VideoDriver *Video)
       EndPixelX += TILE_SIZE / 2;
       EndPixelY += (TILE_SIZE / 2) + (TILE_SIZE / 4);
 
+      if(!IsLineInView(StartPixelX, StartPixelY, EndPixelX, EndPixelY)) { continue; }
+
       switch(Owner->GetID()) {
       case 1:
         Video->DrawLine(StartPixelX, StartPixelY,
@@ -926,8 +898,10 @@ Game::DrawLinks(VideoDriver *Video)
 void
 Game::DrawOwnerHighlights(VideoDriver *Video)
 {
-  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
-    Base *TargetBase = GameWorld->GetBase(I);
+  PROFILE_ZONE(DrawOwnerHighlights);
+
+  for(size_t I = 0; I < ViewBases.size(); I++) {
+    Base *TargetBase = ViewBases[I];
     int LocX, LocY;
 
     TargetBase->GetLoc(LocX, LocY);
@@ -959,6 +933,8 @@ Game::DrawOwnerHighlights(VideoDriver *Video)
 void
 Game::DrawSelectedBase(VideoDriver *Video)
 {
+  PROFILE_ZONE(DrawSelectedBase);
+
   int LocX, LocY;
 
   if(HumanPlayer->GetSelectedBase() != nullptr) {
@@ -982,45 +958,43 @@ Game::DrawStatusRect(VideoDriver *Video,
 }
 
 void
-Game::FindNearbyEnemyBase(VideoDriver *Video, const Player *TargetPlayer)
+Game::DrawWorld(VideoDriver *Video)
 {
-  int WindowWidth, WindowHeight;
-  Base *ClosestEnemyBase = nullptr;
-  int ClosestDistance = -1;
-
-  Video->GetWindowSize(WindowWidth, WindowHeight);
+  PROFILE_ZONE(DrawWorld);
 
-  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
-    Base *TargetBase = GameWorld->GetBase(I);
+  int SizeX, SizeY;
+  int MinX, MinY, MaxX, MaxY;
 
-    if(TargetBase->GetOwner() != nullptr &&
-       TargetBase->GetOwner() != TargetPlayer) {
-      int TileX, TileY;
-      int LocX, LocY;
-      int Distance;
-      int X, Y;
+  GameWorld->GetSize(SizeX, SizeY);
 
-      GetMousePointerTileLoc(WindowWidth / 2, WindowHeight / 2, TileX, TileY);
-      TargetBase->GetLoc(LocX, LocY);
+  // The box around the view diamond.
+  MinX = std::max(-FloorDiv(-(ViewMinSum - ViewMaxDiff), 2), 0);
+  MaxX = std::min(FloorDiv(ViewMaxSum - ViewMinDiff, 2), SizeX - 1);
+  MinY = std::max(-FloorDiv(-(ViewMinDiff + ViewMinSum), 2), 0);
+  MaxY = std::min(FloorDiv(ViewMaxDiff + ViewMaxSum, 2), SizeY - 1);
 
-      X = LocX - TileX;
-      Y = LocY - TileY;
+  Terrain.Draw(Video, Offset_X, Offset_Y, MinX, MinY, MaxX, MaxY, ShowGrid);
 
-      X *= X;
-      Y *= Y;
-      Distance = ceil(sqrt(X + Y));
+  for(size_t I = 0; I < ViewBases.size(); I++) {
+    Base *TargetBase = ViewBases[I];
+    int X, Y;
 
-      if(ClosestDistance < 0) {
-        ClosestEnemyBase = TargetBase;
-        ClosestDistance = Distance;
-      } else {
-        if(Distance < ClosestDistance) {
-          ClosestEnemyBase = TargetBase;
-          ClosestDistance = Distance;
-        }
-      }
-    }
+    TargetBase->GetLoc(X, Y);
+    Video->DrawTile(X, Y, Offset_X, Offset_Y, TileType::Base);
   }
+}
+
+void
+Game::FindNearbyEnemyBase(VideoDriver *Video, const Player *TargetPlayer)
+{
+  int WindowWidth, WindowHeight;
+  Base *ClosestEnemyBase;
+  int TileX, TileY;
+
+  Video->GetWindowSize(WindowWidth, WindowHeight);
+  GetMousePointerTileLoc(WindowWidth / 2, WindowHeight / 2, TileX, TileY);
+
+  ClosestEnemyBase = GameWorld->GetNearestEnemyBase(TileX, TileY, TargetPlayer);
 
   CenterOnBase(Video, ClosestEnemyBase);
 }
@@ -1060,85 +1034,187 @@ Game::GetTilePixelLoc(const int X,
   PixelY = ((X + Y) * (TILE_SIZE / 4)) + Offset_Y;
 }
 
+// Whether the box around a line, and the marker at its end, is on screen.
+bool
+Game::IsLineInView(const int StartPixelX,
+                   const int StartPixelY,
+                   const int EndPixelX, const int EndPixelY) const
+{
+  if(std::max(StartPixelX, EndPixelX) + 4 < 0)          { return false; }
+  if(std::max(StartPixelY, EndPixelY) + 4 < 0)          { return false; }
+  if(std::min(StartPixelX, EndPixelX) - 4 >= ViewWidth)  { return false; }
+  if(std::min(StartPixelY, EndPixelY) - 4 >= ViewHeight) { return false; }
+
+  return true;
+}
+
+bool
+Game::IsTileInView(const int X, const int Y) const
+{
+  return (Y - X >= ViewMinDiff && Y - X <= ViewMaxDiff &&
+          X + Y >= ViewMinSum && X + Y <= ViewMaxSum);
+}
+
 void
 Game::LinkBases(Base *SrcBase, Base *DstBase)
 {
-  const int Distance = SrcBase->GetDistanceToBase(DstBase);
+  RunCommand(CommandType::Link, SrcBase, DstBase);
+}
 
-  // Unlink the two base if they are already linked together.
-  if(SrcBase->GetTargetBase() != nullptr) {
-    if(SrcBase->GetTargetBase()->GetID() == DstBase->GetID()) {
-      SrcBase->ChangeTargetBase(nullptr);
-    }
-  } else {
-    // Check if the destination base has a linked base.
-    if(DstBase->GetTargetBase() != nullptr) {
-      // If destination base linked to the source base, then unlinked them both.
-      if(DstBase->GetTargetBase()->GetID() == SrcBase->GetID()) {
-        DstBase->ChangeTargetBase(nullptr);
-      } else {
-        if(Distance <= 24) { SrcBase->ChangeTargetBase(DstBase); }
-      }
-    } else {
-      if(Distance <= 24) { SrcBase->ChangeTargetBase(DstBase); }
-    }
+void
+Game::RouteToBase(void)
+{
+  if(HumanPlayer->GetSelectedBase() != nullptr) {
+    RunCommand(CommandType::Route, HumanPlayer->GetSelectedBase(), nullptr);
   }
 }
 
+// Every action of the human player goes through the simulation as a
+// command, so it ends up in the replay.
 void
-Game::PlayersTick(const double Delta, std::minstd_rand &Rand)
+Game::RunCommand(const CommandType Type, Base *SrcBase, Base *TargetBase)
 {
-  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) {
-    Players[I].Tick(this, Delta, Rand);
-  }
+  Command NewCommand;
+
+  NewCommand.Type = Type;
+  NewCommand.PlayerNum = (int) HumanPlayer->GetID() - 1;
+  NewCommand.SrcBase = SrcBase->GetIndex();
+  NewCommand.TargetBase = (TargetBase != nullptr) ? TargetBase->GetIndex() : -1;
+
+  MainSimulation->RunCommand(NewCommand);
 }
 
 void
-Game::SelectedTileInput(const int X,
-                        const int Y, std::minstd_rand &Rand)
+Game::SelectedTileInput(const int X, const int Y)
 {
+  Base *TargetBase;
   int TileX, TileY;
-  int LocX, LocY;
 
   if(MainWindow != nullptr) { return; }
 
   GetMousePointerTileLoc(X, Y, TileX, TileY);
 
-  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
-    Base *TargetBase = GameWorld->GetBase(I);
+  TargetBase = GameWorld->GetBaseByLoc(TileX, TileY);
+  if(TargetBase == nullptr) { return; }
 
-    TargetBase->GetLoc(LocX, LocY);
-    if(TileX == LocX && (int) TileY == LocY) {
 #if DEBUG_INPUT
-      std::cerr << "Input: SelectedTileInput Called" << std::endl;
+  std::cerr << "Input: SelectedTileInput Called" << std::endl;
 #endif /* DEBUG_INPUT */
 
-      if(TargetBase->GetOwner() == HumanPlayer) {
-        /* Unselected player's target base. */
-        if(HumanPlayer->GetSelectedBase() == TargetBase) {
-          HumanPlayer->ChangeSelectedBase(nullptr);
-          /* Link two bases together. */
-        } else if(HumanPlayer->GetSelectedBase() != nullptr &&
-                  HumanPlayer->GetSelectedBase() != TargetBase &&
-                  TargetBase->GetOwner() == HumanPlayer) {
-          LinkBases(HumanPlayer->GetSelectedBase(), TargetBase);
-          Application->GetAudioDriver()->PlaySelectedSound();
-          /* Change selected base tile. */
-        } else {
-          HumanPlayer->ChangeSelectedBase(TargetBase);
-          Application->GetAudioDriver()->PlaySelectedSound();
-        }
-        /* Colonize base if it has no owner. */
-      } else if(TargetBase->GetOwner() == nullptr) {
-        ColonizeBase(TargetBase, HumanPlayer);
-        /* Attack base if it has an owner. */
-      } else if(TargetBase->GetOwner() != HumanPlayer &&
-                TargetBase->GetOwner() != nullptr &&
-                HumanPlayer->GetSelectedBase() != nullptr) {
-        if(TargetBase->GetDistanceToBase(HumanPlayer->GetSelectedBase()) <= 24) {
-          AttackBase(HumanPlayer->GetSelectedBase(), TargetBase, Rand);
-        }
-      }
+  if(TargetBase->GetOwner() == HumanPlayer) {
+    /* Unselected player's target base. */
+    if(HumanPlayer->GetSelectedBase() == TargetBase) {
+      HumanPlayer->ChangeSelectedBase(nullptr);
+      /* Link two bases together. */
+    } else if(HumanPlayer->GetSelectedBase() != nullptr &&
+              HumanPlayer->GetSelectedBase() != TargetBase &&
+              TargetBase->GetOwner() == HumanPlayer) {
+      LinkBases(HumanPlayer->GetSelectedBase(), TargetBase);
+      Audio->PlaySelectedSound();
+      /* Change selected base tile. */
+    } else {
+      HumanPlayer->ChangeSelectedBase(TargetBase);
+      Audio->PlaySelectedSound();
+    }
+    /* Colonize base if it has no owner. */
+  } else if(TargetBase->GetOwner() == nullptr) {
+    ColonizeBase(TargetBase, HumanPlayer);
+    /* Attack base if it has an owner. */
+  } else if(TargetBase->GetOwner() != HumanPlayer &&
+            TargetBase->GetOwner() != nullptr &&
+            HumanPlayer->GetSelectedBase() != nullptr) {
+    if(TargetBase->GetDistanceToBase(HumanPlayer->GetSelectedBase()) <= MAX_BASE_DISTANCE) {
+      AttackBase(HumanPlayer->GetSelectedBase(), TargetBase);
     }
   }
 }
+
+void
+Game::Setup(VideoDriver *Video)
+{
+  MainSimulation->ChangeAttackSignal(SIGNAL(PlayAttackingSound), Audio);
+
+  // A plan that is late is put off rather than let it hold the frame up.
+  AIPool = new ThreadPool();
+  if(AIPool->Create(AI_THREADS)) {
+    MainSimulation->ChangeAIPool(AIPool);
+    MainSimulation->ChangeDelayLateAIPlans(true);
+  }
+
+  GameWorld = MainSimulation->GetWorld();
+  HumanPlayer = MainSimulation->GetHumanPlayer();
+  Terrain.Create(GameWorld);
+
+  this->ShowGrid = false;
+  this->CloseMainWindow = false;
+  this->Offset_X = 0;
+  this->Offset_Y = 0;
+  this->Mouse_OldLocX = 0;
+  this->Mouse_OldLocY = 0;
+  this->LeftMouseButtonPressed = false;
+  this->RightMouseButtonPressed = false;
+  this->EndGameTick = 0.0;
+
+  if(HumanPlayer->GetHomeBase() != nullptr) {
+    CenterOnBase(Video, HumanPlayer->GetHomeBase());
+  }
+}
+
+// Works out which tiles and bases can be seen, by turning the window edges
+// back through GetTilePixelLoc().  A tile covers TILE_SIZE pixels to the
+// right of and below its pixel location.
+void
+Game::UpdateViewArea(VideoDriver *Video)
+{
+  int MinX, MinY, MaxX, MaxY;
+  size_t NumViewBases = 0;
+
+  Video->GetWindowSize(ViewWidth, ViewHeight);
+
+  // -TILE_SIZE < (Y - X) * (TILE_SIZE / 2) + Offset_X < ViewWidth
+  ViewMinDiff = FloorDiv(-TILE_SIZE - Offset_X, TILE_SIZE / 2) + 1;
+  ViewMaxDiff = -FloorDiv(Offset_X - ViewWidth, TILE_SIZE / 2) - 1;
+
+  // -TILE_SIZE < (X + Y) * (TILE_SIZE / 4) + Offset_Y < ViewHeight
+  ViewMinSum = FloorDiv(-TILE_SIZE - Offset_Y, TILE_SIZE / 4) + 1;
+  ViewMaxSum = -FloorDiv(Offset_Y - ViewHeight, TILE_SIZE / 4) - 1;
+
+  // The box around the diamond, grown by how far a link or attack reaches.
+  MinX = FloorDiv(ViewMinSum - ViewMaxDiff, 2) - MAX_BASE_DISTANCE;
+  MaxX = FloorDiv(ViewMaxSum - ViewMinDiff + 1, 2) + MAX_BASE_DISTANCE;
+  MinY = FloorDiv(ViewMinSum + ViewMinDiff, 2) - MAX_BASE_DISTANCE;
+  MaxY = FloorDiv(ViewMaxSum + ViewMaxDiff + 1, 2) + MAX_BASE_DISTANCE;
+
+  GameWorld->GetBasesInArea(MinX, MinY, MaxX, MaxY, ViewLinkBases);
+
+  // Keep the drawing order of the world's base array.
+  std::sort(ViewLinkBases.begin(), ViewLinkBases.end(),
+            [](const Base *A, const Base *B) { return A->GetIndex() < B->GetIndex(); });
+
+  ViewBases.resize(ViewLinkBases.size());
+  for(size_t I = 0; I < ViewLinkBases.size(); I++) {
+    Base *TargetBase = ViewLinkBases[I];
+    int LocX, LocY;
+
+    TargetBase->GetLoc(LocX, LocY);
+    if(IsTileInView(LocX, LocY)) { ViewBases[NumViewBases++] = TargetBase; }
+  }
+
+  ViewBases.resize(NumViewBases);
+}
+
+// Signal Functions for Game
+static void
+PlayAttackingSound(Simulation *MainSimulation, AudioDriver *Audio)
+{
+  if(MainSimulation == nullptr) { abort(); }
+
+  Audio->PlayAttackingSound();
+}
+
+// Helper Functions for Game
+static int
+FloorDiv(const int Value, const int Divisor)
+{
+  return (Value >= 0) ? Value / Divisor : -((-Value + Divisor - 1) / Divisor);
+}
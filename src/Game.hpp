@@ -24,11 +24,17 @@
 class Game;
 
 #include <random>
+#include <vector>
 #include <SDL2/SDL_events.h>
 
+#include "Audio.hpp"
 #include "Base.hpp"
 #include "Config.hpp"
 #include "Player.hpp"
+#include "Replay.hpp"
+#include "Simulation.hpp"
+#include "TerrainCache.hpp"
+#include "ThreadPool.hpp"
 #include "Tile.hpp"
 #include "Video.hpp"
 #include "Window.hpp"
@@ -41,30 +47,41 @@ private:
   int Offset_Y;
   int Mouse_OldLocX;
   int Mouse_OldLocY;
+  bool LeftMouseButtonPressed;
+  bool RightMouseButtonPressed;
   double EndGameTick;
-
-  int DifficultyValue;
+
+  AudioDriver *Audio;
 
   bool CloseMainWindow;
   Window *NewWindow;
   Window *MainWindow;
 
+  Simulation *MainSimulation;
   World *GameWorld;
+  Replay *Recording;
+  ThreadPool *AIPool; // The AIs plan here, off the frame
+  TerrainCache Terrain;
 
+  // The tiles on screen form a diamond in tile space, bounded by Y - X
+  // and X + Y.  Updated at the start of every Draw().
+  int ViewWidth;
+  int ViewHeight;
+  int ViewMinDiff, ViewMaxDiff;
+  int ViewMinSum, ViewMaxSum;
+  std::vector<Base *> ViewBases;     // Bases on screen
+  std::vector<Base *> ViewLinkBases; // Bases whose link or attack may be on screen
+
   Player *HumanPlayer;
-  Player Players[NUMBER_OF_PLAYERS];
 
-  void AssignPlayerBases(std::minstd_rand &Rand);
-  void AttackBase(Base *SrcBase, Base *TargetBase, std::minstd_rand &Rand);
-  void BasesTick(const double Delta, std::minstd_rand &Rand);
+  void AttackBase(Base *SrcBase, Base *TargetBase);
   void CenterOnBase(VideoDriver *Video, const Base *TargetBase);
   void CheckMapBoarder(VideoDriver *Video, const int X, const int Y);
   void CheckIfAIPlayersAreAlive(const double Delta, VideoDriver *Video);
   void CheckIfHumanPlayerIsAlive(const double Delta, VideoDriver *Video);
-  void CheckIfPlayersAreAlive(void);
   void CheckMusic(std::minstd_rand &Rand);
-  void CheckToCloseWindow(void);
-  void CreatePlayers(void);
+  void CheckSelectedBase(void);
+  bool CheckToCloseWindow(void);
   void DestroyLink(void);
   void DrawAttacks(VideoDriver *Video);
   void DrawBaseStatus(VideoDriver *Video);
@@ -79,6 +96,7 @@ private:
                       const int Width,
                       const int Height,
                       const int X, const int Y);
+  void DrawWorld(VideoDriver *Video);
   void FindNearbyEnemyBase(VideoDriver *Video, const Player *TargetPlayer);
   void GetMousePointerTileLoc(const int X,
                               const int Y,
@@ -86,10 +104,16 @@ private:
   void GetTilePixelLoc(const int X,
                        const int Y,
                        int &PixelX, int &PixelY);
+  bool IsLineInView(const int StartPixelX,
+                    const int StartPixelY,
+                    const int EndPixelX, const int EndPixelY) const;
+  bool IsTileInView(const int X, const int Y) const;
   void LinkBases(Base *SrcBase, Base *DstBase);
-  void PlayersTick(const double Delta, std::minstd_rand &Rand);
-  void SelectedTileInput(const int X,
-                         const int Y, std::minstd_rand &Rand);
+  void RouteToBase(void);
+  void RunCommand(const CommandType Type, Base *SrcBase, Base *TargetBase);
+  void SelectedTileInput(const int X, const int Y);
+  void Setup(VideoDriver *Video);
+  void UpdateViewArea(VideoDriver *Video);
 public:
   ~Game(void);
   Game(void) { }
@@ -98,17 +122,22 @@ public:
   void CloseWindow(void);
   void ColonizeBase(Base *TargetBase, Player *TargetPlayer);
   void Draw(VideoDriver *Video);
-  void FindNewHomeBase(Player *TargetPlayer);
   bool GetGridValue(void) const { return ShowGrid; }
   Player *GetHumanPlayer(void) { return HumanPlayer; }
-  Player *GetPlayer(const int I);
+  int GetNumPlayers(void) const { return MainSimulation->GetNumPlayers(); }
+  Player *GetPlayer(const int I) { return MainSimulation->GetPlayer(I); }
   World *GetWorld(void) { return GameWorld; }
-  bool Init(const int DifficultyValue,
-            VideoDriver *Video, std::minstd_rand &Rand);
-  void Input(SDL_Event *Event,
-             VideoDriver *Video, std::minstd_rand &Rand);
+  bool Init(const WorldSettings &Settings,
+            const int DifficultyValue,
+            VideoDriver *Video,
+            AudioDriver *Audio, std::minstd_rand &Rand);
+  void Input(SDL_Event *Event, VideoDriver *Video);
+  bool IsMatchOver(void);
   bool IsWindowOpen(void) const { return (MainWindow != nullptr) ? true : false; }
-  void Tick(const double Delta, VideoDriver *Video, std::minstd_rand &Rand);
+  bool Load(const char *FileName, VideoDriver *Video, AudioDriver *Audio);
+  bool Save(const char *FileName);
+  bool SaveReplay(const char *FileName);
+  bool Tick(const double Delta, VideoDriver *Video, std::minstd_rand &Rand);
   TileType TileProbablity(const unsigned int RandValue);
 };
 
@@ -0,0 +1,654 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Runs AI versus AI matches without any video or audio, as fast as the CPU
+// allows, to measure the simulation throughput separately from drawing.
+// The matches are spread over a thread pool and the results are summed up
+// per AI configuration given with --ai.
+// With --benchmark it instead times the base update against the old
+// array of Base objects layout, with --mapgen it times the terrain
+// generator, and with --record and --replay it writes a replay of one
+// match or plays one back and checks it for desyncs.  With --ai-pool the
+// recorded match plans its AIs on the thread pool, as a game does.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <vector>
+
+#include "Config.hpp"
+#include "MatchRunner.hpp"
+#include "Replay.hpp"
+#include "Simulation.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+
+struct HeadlessOptions {
+  bool Benchmark;
+  bool AIPool;
+  int MapgenSize;
+  WorldSettings World;
+  const char *RecordFile;
+  const char *ReplayFile;
+  std::vector<AIConfig> Configs;
+  int NumThreads;
+  int NumMatches;
+  int DifficultyValue;
+  unsigned int Seed;
+  int TickRate;
+  double MaxGameTime;
+};
+
+// The base as it was laid out before BaseTable, hot and cold fields mixed.
+struct LegacyBase {
+  int LocX, LocY;
+  int Size;
+  int DefenceValue;
+  BaseID ID;
+  double Soldiers;
+  LegacyBase *AttackingBase;
+  int AttackRoll;
+  int DefenseRoll;
+  LegacyBase *TargetBase;
+  Player *Owner;
+  double TransferRate;
+};
+
+static const char *GetPlannerName(const AIPlanner Planner);
+static void LegacyBaseTick(LegacyBase *TargetBase, const double Delta, const int DifficultyValue);
+static bool ParseAIConfig(const char *String, AIConfig &Config);
+static bool ParseOptions(const int argc, char **argv, HeadlessOptions &Options);
+static void PrintUsage(const char *ProgramName);
+static bool PlayReplay(const char *FileName);
+static bool RecordMatch(const HeadlessOptions &Options, ThreadPool *AIPool);
+static void RunBaseBenchmark(const int NumBases);
+static bool RunMapgenBenchmark(const int Size, const unsigned int Seed, ThreadPool *Pool);
+
+int main(int argc, char **argv)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  HeadlessOptions Options;
+  MatchSettings Settings;
+  MatchRunner Runner;
+  ThreadPool Pool;
+  std::vector<int> Wins;
+  double CreateTime = 0.0;
+  double TickTime = 0.0;
+  long long NumTicks = 0;
+  int NumTimeouts = 0;
+  Clock::time_point StartTime;
+
+  if(!ParseOptions(argc, argv, Options)) {
+    PrintUsage(argv[0]);
+
+    return EXIT_FAILURE;
+  }
+
+  if(Options.Benchmark) {
+    printf("Bases      Legacy ticks/s  Table ticks/s   Speedup\n");
+    RunBaseBenchmark(64);
+    RunBaseBenchmark(4096);
+    RunBaseBenchmark(262144);
+
+    return EXIT_SUCCESS;
+  }
+
+  if(Options.MapgenSize > 0) {
+    if(!Pool.Create(Options.NumThreads)) {
+      fprintf(stderr, "Error: Could not create the thread pool.\n");
+
+      return EXIT_FAILURE;
+    }
+
+    return RunMapgenBenchmark(Options.MapgenSize, Options.Seed, &Pool) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if(Options.ReplayFile != nullptr) {
+    return PlayReplay(Options.ReplayFile) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if(Options.RecordFile != nullptr) {
+    if(Options.AIPool && !Pool.Create(Options.NumThreads)) {
+      fprintf(stderr, "Error: Could not create the thread pool.\n");
+
+      return EXIT_FAILURE;
+    }
+
+    return RecordMatch(Options, Options.AIPool ? &Pool : nullptr) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  Settings.World = Options.World;
+  Settings.DifficultyValue = Options.DifficultyValue;
+  Settings.Seed = Options.Seed;
+  Settings.TickRate = Options.TickRate;
+  Settings.MaxGameTime = Options.MaxGameTime;
+
+  if(!Pool.Create(Options.NumThreads) ||
+     !Runner.Create(Settings, Options.Configs.data(), (int) Options.Configs.size())) {
+    fprintf(stderr, "Error: Could not create the match runner.\n");
+
+    return EXIT_FAILURE;
+  }
+
+  Wins.assign(Options.World.NumPlayers, 0);
+  StartTime = Clock::now();
+
+  if(!Runner.Run(&Pool, Options.NumMatches)) {
+    fprintf(stderr, "Error: Could not create every match.\n");
+
+    return EXIT_FAILURE;
+  }
+
+  const double TotalTime = std::chrono::duration<double>(Clock::now() - StartTime).count();
+
+  for(int I = 0; I < Runner.GetNumResults(); I++) {
+    const MatchResult &Result = Runner.GetResult(I);
+
+    CreateTime += Result.CreateTime;
+    TickTime += Result.TickTime;
+    NumTicks += Result.Ticks;
+
+    if(Result.Winner >= 0) {
+      Wins[Result.Winner]++;
+    } else {
+      NumTimeouts++;
+    }
+  }
+
+  printf("Matches:           %d (seed %u, difficulty %d, %d Hz)\n",
+         Options.NumMatches, Options.Seed, Options.DifficultyValue, Options.TickRate);
+  printf("World:             %d x %d, %d bases, %d players\n", Options.World.SizeX,
+         Options.World.SizeY, Options.World.NumBases, Options.World.NumPlayers);
+  printf("Threads:           %d\n", Pool.GetNumThreads());
+  printf("Total time:        %.3f s\n", TotalTime);
+  printf("Matches/second:    %.3f\n", Options.NumMatches / TotalTime);
+  printf("Ticks:             %lld (%.1f per match)\n",
+         NumTicks, (double) NumTicks / Options.NumMatches);
+  printf("Ticks/second:      %.0f (per thread)\n", (NumTicks > 0) ? NumTicks / TickTime : 0.0);
+  printf("Time per tick:     %.3f us\n", (NumTicks > 0) ? (TickTime * 1000000.0) / NumTicks : 0.0);
+  printf("Time per creation: %.3f ms\n", (CreateTime * 1000.0) / Options.NumMatches);
+
+  for(int I = 0; I < Options.World.NumPlayers; I++) {
+    printf("Player %d wins:     %d\n", I + 1, Wins[I]);
+  }
+
+  printf("Timeouts:          %d\n", NumTimeouts);
+
+  printf("\nAI  Planner     Decision  Attack  Colonize  Unlink  Seats  Wins  Win rate  Avg score\n");
+  for(int I = 0; I < Runner.GetNumConfigs(); I++) {
+    const AIConfig &Config = Options.Configs[I];
+    const ConfigStats Stats = Runner.GetConfigStats(I);
+
+    printf("%-3d %-11s %-9.2f %-7u %-9u %-7u %-6d %-5d %-9.3f %.1f\n",
+           I, GetPlannerName(Config.Planner), Config.DecisionTime, Config.ChanceToAttack,
+           Config.ChanceToColonize, Config.ChanceToUnlinkBase, Stats.Matches, Stats.Wins,
+           (Stats.Matches > 0) ? (double) Stats.Wins / Stats.Matches : 0.0,
+           (Stats.Matches > 0) ? (double) Stats.TotalScore / Stats.Matches : 0.0);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+static const char *
+GetPlannerName(const AIPlanner Planner)
+{
+  switch(Planner) {
+  case AIPlanner::Dice:
+    return "dice";
+  case AIPlanner::Utility:
+    return "utility";
+  case AIPlanner::MonteCarlo:
+    return "montecarlo";
+  default:
+    abort();
+  }
+}
+
+// Same work as Base::Tick did for a base before the growth was moved
+// into BaseTable::Grow().
+static void
+LegacyBaseTick(LegacyBase *TargetBase, const double Delta, const int DifficultyValue)
+{
+  double AiDifficulityModifier;
+
+  switch(DifficultyValue) {
+  case 0:
+    AiDifficulityModifier = 0.5;
+    break;
+  case 1:
+    AiDifficulityModifier = 0.75;
+    break;
+  case 2:
+    AiDifficulityModifier = 1.0;
+    break;
+  case 3:
+    AiDifficulityModifier = 1.15;
+    break;
+  case 4:
+    AiDifficulityModifier = 1.3;
+    break;
+  default:
+    abort();
+  }
+
+  if(TargetBase->Owner != nullptr) {
+    double NewSoldiers;
+
+    if(TargetBase->Owner->IsHuman()) {
+      NewSoldiers = ((Delta * (double) TargetBase->Size) / 10.0);
+    } else {
+      NewSoldiers = ((Delta * (double) TargetBase->Size) / 10.0) * AiDifficulityModifier;
+    }
+
+    if(TargetBase->Soldiers + NewSoldiers > MAX_BASE_SOLDIERS) {
+      TargetBase->Soldiers = MAX_BASE_SOLDIERS;
+    } else {
+      TargetBase->Soldiers += NewSoldiers;
+    }
+
+    if(TargetBase->TargetBase != nullptr) {
+      const double Move = (TargetBase->Soldiers * TargetBase->TransferRate) * Delta;
+
+      if(TargetBase->TargetBase->Soldiers + Move < MAX_BASE_SOLDIERS) {
+        TargetBase->Soldiers -= Move;
+        TargetBase->TargetBase->Soldiers += Move;
+      }
+    }
+  }
+}
+
+// Reads "DecisionTime,Attack,Colonize,Unlink[,Planner]", e.g. "8,20,4,2"
+// or "8,20,4,2,dice".  Without a planner the AI uses the Utility one.
+static bool
+ParseAIConfig(const char *String, AIConfig &Config)
+{
+  double DecisionTime;
+  unsigned int Attack, Colonize, Unlink;
+  int Length = 0;
+
+  if(sscanf(String, "%lf,%u,%u,%u%n", &DecisionTime, &Attack, &Colonize, &Unlink, &Length) != 4) {
+    return false;
+  }
+
+  if(String[Length] == '\0') {
+    Config.Planner = DefaultAIConfig.Planner;
+  } else if(strcmp(&String[Length], ",dice") == 0) {
+    Config.Planner = AIPlanner::Dice;
+  } else if(strcmp(&String[Length], ",utility") == 0) {
+    Config.Planner = AIPlanner::Utility;
+  } else if(strcmp(&String[Length], ",montecarlo") == 0) {
+    Config.Planner = AIPlanner::MonteCarlo;
+  } else {
+    return false;
+  }
+
+  // The chances are 1 in N; the AI halves the attack chance against linked bases.
+  if(DecisionTime <= 0.0 || Attack < 2 || Colonize < 1 || Unlink < 1) { return false; }
+
+  Config.DecisionTime = DecisionTime;
+  Config.ChanceToAttack = Attack;
+  Config.ChanceToColonize = Colonize;
+  Config.ChanceToUnlinkBase = Unlink;
+
+  return true;
+}
+
+static bool
+ParseOptions(const int argc, char **argv, HeadlessOptions &Options)
+{
+  Options.Benchmark = false;
+  Options.AIPool = false;
+  Options.MapgenSize = 0;
+  Options.World = DefaultWorldSettings;
+  Options.RecordFile = nullptr;
+  Options.ReplayFile = nullptr;
+  Options.Configs.clear();
+  Options.NumThreads = 0;
+  Options.NumMatches = 16;
+  Options.DifficultyValue = 2;
+  Options.Seed = (unsigned int) time(nullptr);
+  Options.TickRate = 60;
+  Options.MaxGameTime = 3600.0;
+
+  for(int I = 1; I < argc; I++) {
+    if(strcmp(argv[I], "--benchmark") == 0) {
+      Options.Benchmark = true;
+      continue;
+    }
+
+    if(strcmp(argv[I], "--ai-pool") == 0) {
+      Options.AIPool = true;
+      continue;
+    }
+
+    if(I + 1 >= argc) { return false; }
+
+    if(strcmp(argv[I], "--ai") == 0) {
+      AIConfig Config;
+
+      if(!ParseAIConfig(argv[++I], Config)) { return false; }
+      Options.Configs.push_back(Config);
+    } else if(strcmp(argv[I], "--mapgen") == 0) {
+      Options.MapgenSize = atoi(argv[++I]);
+    } else if(strcmp(argv[I], "--record") == 0) {
+      Options.RecordFile = argv[++I];
+    } else if(strcmp(argv[I], "--replay") == 0) {
+      Options.ReplayFile = argv[++I];
+    } else if(strcmp(argv[I], "--threads") == 0) {
+      Options.NumThreads = atoi(argv[++I]);
+    } else if(strcmp(argv[I], "--matches") == 0) {
+      Options.NumMatches = atoi(argv[++I]);
+    } else if(strcmp(argv[I], "--size") == 0) {
+      Options.World.SizeX = atoi(argv[++I]);
+      Options.World.SizeY = Options.World.SizeX;
+    } else if(strcmp(argv[I], "--bases") == 0) {
+      Options.World.NumBases = atoi(argv[++I]);
+    } else if(strcmp(argv[I], "--players") == 0) {
+      Options.World.NumPlayers = atoi(argv[++I]);
+    } else if(strcmp(argv[I], "--difficulty") == 0) {
+      Options.DifficultyValue = atoi(argv[++I]);
+    } else if(strcmp(argv[I], "--seed") == 0) {
+      Options.Seed = (unsigned int) strtoul(argv[++I], nullptr, 10);
+    } else if(strcmp(argv[I], "--tick-rate") == 0) {
+      Options.TickRate = atoi(argv[++I]);
+    } else if(strcmp(argv[I], "--max-time") == 0) {
+      Options.MaxGameTime = atof(argv[++I]);
+    } else {
+      return false;
+    }
+  }
+
+  if(Options.Configs.empty()) {
+    Options.Configs.push_back(Simulation::GetDefaultAIConfig(Options.DifficultyValue));
+  }
+
+  if(Options.MapgenSize < 0)                                   { return false; }
+  if(Options.NumThreads < 0)                                   { return false; }
+  if(Options.NumMatches < 1)                                   { return false; }
+  if(!World::CheckSettings(Options.World))                     { return false; }
+  if(Options.DifficultyValue < 0 || Options.DifficultyValue > 4) { return false; }
+  if(Options.TickRate < 1)                                     { return false; }
+  if(Options.MaxGameTime <= 0.0)                               { return false; }
+  if(Options.RecordFile != nullptr && Options.MaxGameTime > REPLAY_MAX_TIME) { return false; }
+
+  return true;
+}
+
+static void
+PrintUsage(const char *ProgramName)
+{
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --benchmark      Time the base update at 64, 4k and 256k bases and exit\n"
+          "  --ai D,A,C,U[,P] Add an AI configuration: decision time in seconds, the\n"
+          "                   1 in N chances to attack, colonize and unlink of the dice\n"
+          "                   planner and the planner, dice, utility or montecarlo; can\n"
+          "                   be given more than once (default: 8,20,4,2,utility, or\n"
+          "                   montecarlo at difficulty 4)\n"
+          "  --mapgen N       Time the terrain generator on an N by N map, on one\n"
+          "                   thread and on the pool, and exit\n"
+          "  --record FILE    Play the first match only and write a replay of it\n"
+          "  --ai-pool        Plan the AIs of the --record match on the thread pool and\n"
+          "                   put late plans off, as a game does\n"
+          "  --replay FILE    Play a replay back and check it for desyncs\n"
+          "  --threads N      Number of worker threads (default: one per core)\n"
+          "  --matches N      Number of matches to run (default: 16)\n"
+          "  --size N         Width and height of the world in tiles (default: 96)\n"
+          "  --bases N        Number of bases, at least three per player (default: 64)\n"
+          "  --players N      Number of players, up to 64 (default: 4)\n"
+          "  --difficulty N   Difficulty value from 0 to 4 (default: 2)\n"
+          "  --seed N         Seed of the first match (default: time)\n"
+          "  --tick-rate N    Simulation ticks per second (default: 60)\n"
+          "  --max-time N     Seconds of game time before a match is a draw (default: 3600)\n",
+          ProgramName);
+}
+
+static bool
+PlayReplay(const char *FileName)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  Replay MatchReplay;
+  ReplayResult Result;
+  Clock::time_point Time;
+  double PlayTime;
+
+  if(!MatchReplay.Load(FileName)) {
+    fprintf(stderr, "Error: Could not load the replay %s.\n", FileName);
+
+    return false;
+  }
+
+  Time = Clock::now();
+  if(!MatchReplay.Play(Result)) {
+    fprintf(stderr, "Error: The replay %s is broken.\n", FileName);
+
+    return false;
+  }
+
+  PlayTime = std::chrono::duration<double>(Clock::now() - Time).count();
+
+  const double GameTime = (double) Result.Ticks / MatchReplay.GetTickRate();
+
+  printf("Replay:            %s (seed %u, difficulty %d, %d Hz)\n",
+         FileName, MatchReplay.GetSeed(), MatchReplay.GetDifficulty(), MatchReplay.GetTickRate());
+  printf("Ticks:             %lld (%.1f s of game time)\n", Result.Ticks, GameTime);
+  printf("Commands:          %d\n", Result.CommandsRun);
+  printf("Play time:         %.3f s (%.0fx real time)\n",
+         PlayTime, (PlayTime > 0.0) ? GameTime / PlayTime : 0.0);
+  printf("Hashes checked:    %d\n", Result.HashesChecked);
+
+  if(Result.DesyncTick >= 0) {
+    printf("Desync:            at tick %lld\n", Result.DesyncTick);
+
+    return false;
+  }
+
+  printf("Desync:            none\n");
+
+  return true;
+}
+
+// Plays the first match of a run, as MatchRunner would, and records it.
+// With an AIPool the AIs plan on it and put late plans off, so the match
+// depends on the timing of the threads, but the replay still plays back
+// the same on the simulation's thread.
+static bool
+RecordMatch(const HeadlessOptions &Options, ThreadPool *AIPool)
+{
+  const double Delta = 1.0 / (double) Options.TickRate;
+  const long long MaxTicks = (long long) (Options.MaxGameTime * Options.TickRate);
+
+  std::vector<AIConfig> PlayerConfigs(Options.World.NumPlayers);
+  Replay MatchReplay;
+  Simulation Match;
+
+  for(int I = 0; I < Options.World.NumPlayers; I++) {
+    PlayerConfigs[I] = Options.Configs[I % Options.Configs.size()];
+  }
+
+  if(!Match.Create(Options.World, Options.DifficultyValue, false,
+                    Options.Seed, PlayerConfigs.data()) ||
+     !MatchReplay.Create(Options.World, Options.Seed, Options.DifficultyValue, false,
+                         Options.TickRate, REPLAY_HASH_INTERVAL, PlayerConfigs.data())) {
+    fprintf(stderr, "Error: Could not create the match.\n");
+
+    return false;
+  }
+
+  Match.ChangeRecorder(&MatchReplay);
+  if(AIPool != nullptr) {
+    Match.ChangeAIPool(AIPool);
+    Match.ChangeDelayLateAIPlans(true);
+  }
+
+  while(Match.GetTickCount() < MaxTicks && Match.GetNumPlayersAlive() > 1) {
+    Match.Tick(Delta);
+  }
+
+  MatchReplay.Finish(Match.GetTickCount(), Match.GetStateHash());
+
+  if(!MatchReplay.Save(Options.RecordFile)) {
+    fprintf(stderr, "Error: Could not write the replay %s.\n", Options.RecordFile);
+
+    return false;
+  }
+
+  printf("Recorded:          %s (%lld ticks, %zu bytes of commands and hashes)\n",
+         Options.RecordFile, Match.GetTickCount(), MatchReplay.GetStreamSize());
+
+  return true;
+}
+
+// Builds NumBases bases, one in sixteen linked to another base of the same
+// player, and ticks them with both layouts for about 16M base updates.
+static void
+RunBaseBenchmark(const int NumBases)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  const int NumTicks = std::max(16, (1 << 24) / NumBases);
+  const double Delta = 1.0 / 60.0;
+
+  Player Players[NUMBER_OF_PLAYERS];
+  std::minstd_rand Rand(1);
+  LegacyBase *LegacyBases;
+  double LegacyTime, TableTime;
+  BaseTable Table;
+  SupplyGraph Supply;
+  Base *Bases;
+  Clock::time_point Time;
+
+  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) { Players[I].Create(I + 1, false, DefaultAIConfig, 0.0, 1); }
+
+  Table.Create(NumBases);
+  Supply.Create(NumBases);
+  Bases = new Base[NumBases];
+  LegacyBases = new LegacyBase[NumBases];
+
+  for(int I = 0; I < NumBases; I++) {
+    Player *Owner = (I % 8 == 7) ? nullptr : &Players[I % NUMBER_OF_PLAYERS];
+    const int Size = (I % 9) + 1;
+
+    Bases[I].Create(I % 1024, I / 1024, I + 1, Size, 0, &Table, &Supply, I);
+    Bases[I].ChangeOwner(Owner);
+    Bases[I].ChangeSoldiers(10.0);
+
+    LegacyBases[I].LocX = I % 1024;
+    LegacyBases[I].LocY = I / 1024;
+    LegacyBases[I].Size = Size;
+    LegacyBases[I].DefenceValue = 0;
+    LegacyBases[I].ID = I + 1;
+    LegacyBases[I].Soldiers = 10.0;
+    LegacyBases[I].AttackingBase = nullptr;
+    LegacyBases[I].TargetBase = nullptr;
+    LegacyBases[I].Owner = Owner;
+    LegacyBases[I].TransferRate = 0.0;
+  }
+
+  for(int I = 16; I < NumBases; I += 16) {
+    Bases[I].ChangeTargetBase(&Bases[I - 4]);
+    LegacyBases[I].TargetBase = &LegacyBases[I - 4];
+    LegacyBases[I].TransferRate = GetTransferEfficiency(Bases[I].GetDistanceToBase(&Bases[I - 4]));
+  }
+
+  Time = Clock::now();
+  for(int Tick = 0; Tick < NumTicks; Tick++) {
+    for(int I = 0; I < NumBases; I++) { LegacyBaseTick(&LegacyBases[I], Delta, 2); }
+  }
+
+  LegacyTime = std::chrono::duration<double>(Clock::now() - Time).count();
+
+  Time = Clock::now();
+  for(int Tick = 0; Tick < NumTicks; Tick++) {
+    Table.Grow(Delta);
+    for(int I = Table.GetNextActive(0); I >= 0; I = Table.GetNextActive(I + 1)) {
+      Bases[I].Tick(Delta, Rand);
+    }
+  }
+
+  TableTime = std::chrono::duration<double>(Clock::now() - Time).count();
+
+  printf("%-10d %-15.0f %-15.0f %.2fx\n",
+         NumBases, NumTicks / LegacyTime, NumTicks / TableTime, LegacyTime / TableTime);
+
+  // The players must not outlive the bases pointing at them.
+  for(int I = 0; I < NumBases; I++) { Bases[I].ChangeOwner(nullptr); }
+
+  delete[] Bases;
+  delete[] LegacyBases;
+}
+
+// Generates the terrain of a Size by Size map for a few seeds, first on
+// this thread and then on the pool, and checks both give the same tiles.
+static bool
+RunMapgenBenchmark(const int Size, const unsigned int Seed, ThreadPool *Pool)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  const int NumSeeds = 3;
+  const double MegaTiles = ((double) Size * Size) / 1000000.0;
+  double Times[2] = { };
+  bool Same = true;
+
+  for(int I = 0; I < NumSeeds; I++) {
+    uint64_t Hashes[2];
+
+    for(int J = 0; J < 2; J++) {
+      World Terrain;
+      std::vector<uint8_t> Packed;
+      Clock::time_point Time;
+
+      Time = Clock::now();
+      if(!Terrain.CreateTerrain(Size, Size, Seed + I, (J == 0) ? nullptr : Pool)) {
+        fprintf(stderr, "Error: Could not generate a %d by %d map.\n", Size, Size);
+
+        return false;
+      }
+      Times[J] += std::chrono::duration<double>(Clock::now() - Time).count();
+
+      // FNV-1a of the packed tiles.
+      Packed.resize(Terrain.GetPackedTilesSize());
+      Terrain.PackTiles(Packed.data());
+      Hashes[J] = 14695981039346656037ULL;
+      for(const uint8_t Byte : Packed) {
+        Hashes[J] = (Hashes[J] ^ Byte) * 1099511628211ULL;
+      }
+    }
+
+    if(Hashes[0] != Hashes[1]) { Same = false; }
+  }
+
+  printf("Map:               %d x %d (%.2f megatiles, seeds %u to %u)\n",
+         Size, Size, MegaTiles, Seed, Seed + NumSeeds - 1);
+  printf("Threads  ms per map  ms per megatile\n");
+  printf("%-8d %-11.3f %.3f\n", 1,
+         (Times[0] * 1000.0) / NumSeeds, (Times[0] * 1000.0) / (NumSeeds * MegaTiles));
+  printf("%-8d %-11.3f %.3f\n", Pool->GetNumThreads(),
+         (Times[1] * 1000.0) / NumSeeds, (Times[1] * 1000.0) / (NumSeeds * MegaTiles));
+  printf("Same terrain:      %s\n", Same ? "yes" : "NO");
+
+  return Same;
+}
@@ -36,6 +36,7 @@
 #include "Window.hpp"
 
 // Signal Functions for the Main Menu
+static void Continue(Button *PressedButton, BcApplication *Application);
 static void Quit(Button *PressedButton, BcApplication *Application);
 static void OptionsMenu(Button *PressedButton, BcApplication *Application);
 static void StartNewGame(Button *PressedButton, BcApplication *Application);
@@ -43,7 +44,7 @@ static void StartNewGame(Button *PressedButton, BcApplication *Application);
 void CreateMainMenu(BcApplication *Application)
 {
   const int MenuWidth = 232;
-  const int MenuHeight = 192;
+  const int MenuHeight = 256;
 
   SDL_Texture *BackgroundTexture;
   int WindowWidth, WindowHeight;
@@ -85,7 +86,15 @@ void CreateMainMenu(BcApplication *Application)
 
   NewButton = new Button;
 
-  NewButton->Create("Options", 200, 32, 0, 80);
+  NewButton->Create("Continue", 200, 32, 0, 80);
+  NewButton->CenterOnX(MenuWidth);
+  NewButton->SetFontScale(2.0);
+  NewButton->ChangeSignal(SIGNAL(Continue), Application);
+  NewWindow->AddWidget(NewButton);
+
+  NewButton = new Button;
+
+  NewButton->Create("Options", 200, 32, 0, 144);
   NewButton->CenterOnX(MenuWidth);
   NewButton->SetFontScale(2.0);
   NewButton->ChangeSignal(SIGNAL(OptionsMenu), Application);
@@ -93,7 +102,7 @@ void CreateMainMenu(BcApplication *Application)
 
   NewButton = new Button;
 
-  NewButton->Create("Quit", 200, 32, 0, 144);
+  NewButton->Create("Quit", 200, 32, 0, 208);
   NewButton->CenterOnX(MenuWidth);
   NewButton->SetFontScale(2.0);
   NewButton->ChangeSignal(SIGNAL(Quit), Application);
@@ -114,6 +123,17 @@ void CreateMainMenu(BcApplication *Application)
   Application->ChangeMenu(NewMenu);
 }
 
+static void
+Continue(Button *PressedButton, BcApplication *Application)
+{
+  if(PressedButton == nullptr) { abort(); }
+
+  // Without an autosave there is nothing to carry on.
+  if(Application->ContinueGame()) {
+    Application->GetAudioDriver()->PlayPressedSound();
+  }
+}
+
 static void
 Quit(Button *PressedButton, BcApplication *Application)
 {
@@ -0,0 +1,125 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MatchRunner.hpp"
+
+#include <chrono>
+
+#include "Simulation.hpp"
+
+bool
+MatchRunner::Create(const MatchSettings &Settings,
+                    const AIConfig *Configs, const int NumConfigs)
+{
+  if(NumConfigs < 1)                         { return false; }
+  if(!World::CheckSettings(Settings.World)) { return false; }
+
+  this->Settings = Settings;
+  this->Configs.assign(Configs, Configs + NumConfigs);
+  this->Results.clear();
+
+  return true;
+}
+
+ConfigStats
+MatchRunner::GetConfigStats(const int Config) const
+{
+  ConfigStats Stats = { 0, 0, 0 };
+
+  for(size_t I = 0; I < Results.size(); I++) {
+    const MatchResult &Result = Results[I];
+
+    if(Result.Failed) { continue; }
+
+    for(int J = 0; J < Settings.World.NumPlayers; J++) {
+      if(Result.Configs[J] != Config) { continue; }
+
+      Stats.Matches++;
+      Stats.TotalScore += Result.Scores[J];
+      if(Result.Winner == J) { Stats.Wins++; }
+    }
+  }
+
+  return Stats;
+}
+
+bool
+MatchRunner::Run(ThreadPool *Pool, const int NumMatches)
+{
+  Results.assign(NumMatches, MatchResult());
+
+  for(int I = 0; I < NumMatches; I++) {
+    Pool->Submit([this, I] { PlayMatch(I); });
+  }
+
+  Pool->Wait();
+
+  for(int I = 0; I < NumMatches; I++) {
+    if(Results[I].Failed) { return false; }
+  }
+
+  return true;
+}
+
+// Private Functions of MatchRunner
+void
+MatchRunner::PlayMatch(const int MatchNum)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  const double Delta = 1.0 / (double) Settings.TickRate;
+  const long long MaxTicks = (long long) (Settings.MaxGameTime * Settings.TickRate);
+  const int NumPlayers = Settings.World.NumPlayers;
+
+  MatchResult &Result = Results[MatchNum];
+  std::vector<AIConfig> PlayerConfigs(NumPlayers);
+  Simulation Match;
+  Clock::time_point Time;
+  Player *Winner;
+
+  // Rotate the configurations through the seats from match to match.
+  Result.Seed = Settings.Seed + (unsigned int) MatchNum;
+  Result.Configs.resize(NumPlayers);
+  Result.Scores.assign(NumPlayers, 0);
+  for(int I = 0; I < NumPlayers; I++) {
+    Result.Configs[I] = (MatchNum + I) % (int) Configs.size();
+    PlayerConfigs[I] = Configs[Result.Configs[I]];
+  }
+
+  Time = Clock::now();
+  Result.Failed = !Match.Create(Settings.World, Settings.DifficultyValue,
+                                false, Result.Seed, PlayerConfigs.data());
+  Result.CreateTime = std::chrono::duration<double>(Clock::now() - Time).count();
+  if(Result.Failed) { return; }
+
+  Time = Clock::now();
+  for(Result.Ticks = 0;
+      Result.Ticks < MaxTicks && Match.GetNumPlayersAlive() > 1; Result.Ticks++) {
+    Match.Tick(Delta);
+  }
+
+  Result.TickTime = std::chrono::duration<double>(Clock::now() - Time).count();
+
+  Winner = Match.GetWinner();
+  Result.Winner = (Winner != nullptr) ? (int) Winner->GetID() - 1 : -1;
+  for(int I = 0; I < NumPlayers; I++) {
+    Result.Scores[I] = Match.GetPlayer(I)->GetScore();
+  }
+}
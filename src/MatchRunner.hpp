@@ -0,0 +1,80 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _MATCHRUNNER_HPP_
+#define _MATCHRUNNER_HPP_
+
+class MatchRunner;
+
+#include <vector>
+
+#include "AiConfig.hpp"
+#include "Config.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+
+struct MatchSettings {
+  WorldSettings World;
+  int DifficultyValue;
+  unsigned int Seed;   // Match N is played with Seed + N
+  int TickRate;
+  double MaxGameTime;  // Seconds of game time before a match is a draw
+};
+
+struct MatchResult {
+  unsigned int Seed;
+  std::vector<int> Configs; // AI configuration of every player
+  std::vector<int> Scores;
+  int Winner;               // Winning player, -1 on a draw
+  long long Ticks;
+  double CreateTime;
+  double TickTime;
+  bool Failed;
+};
+
+struct ConfigStats {
+  int Matches;   // Seats played, one per player using the configuration
+  int Wins;
+  long long TotalScore;
+};
+
+// Plays independent AI versus AI matches, spread over a thread pool.
+// Every match has its own Simulation and random number generator, so the
+// results only depend on the settings and not on the number of threads.
+class MatchRunner {
+private:
+  MatchSettings Settings;
+  std::vector<AIConfig> Configs;
+  std::vector<MatchResult> Results;
+
+  void PlayMatch(const int MatchNum);
+public:
+  MatchRunner(void) { }
+  ~MatchRunner(void) { }
+  bool Create(const MatchSettings &Settings,
+              const AIConfig *Configs, const int NumConfigs);
+  ConfigStats GetConfigStats(const int Config) const;
+  int GetNumConfigs(void) const { return (int) Configs.size(); }
+  int GetNumResults(void) const { return (int) Results.size(); }
+  const MatchResult &GetResult(const int MatchNum) const { return Results[MatchNum]; }
+  bool Run(ThreadPool *Pool, const int NumMatches);
+};
+
+#endif // _MATCHRUNNER_HPP_
@@ -21,13 +21,24 @@
 #include "Player.hpp"
 
 #include "Ai.hpp"
-#include "Game.hpp"
+#include "Simulation.hpp"
 
 Player::~Player(void)
 {
   if(AI != nullptr) { delete ((AIDriver *) AI); }
 }
 
+void
+Player::AddBase(Base *NewBase)
+{
+  NewBase->ChangePrevOwnedBase(nullptr);
+  NewBase->ChangeNextOwnedBase(FirstBase);
+  if(FirstBase != nullptr) { FirstBase->ChangePrevOwnedBase(NewBase); }
+
+  FirstBase = NewBase;
+  NumBases++;
+}
+
 void
 Player::ChangeHomeBase(Base *HomeBase)
 {
@@ -41,7 +52,10 @@ Player::ChangeSelectedBase(Base *SelectedBase)
 }
 
 bool
-Player::Create(const PlayerID ID, const bool Human)
+Player::Create(const PlayerID ID,
+               const bool Human,
+               const AIConfig &Config,
+               const double AIPhase, const unsigned int AISeed)
 {
   this->Human = Human;
   this->Alive = true;
@@ -49,12 +63,14 @@ Player::Create(const PlayerID ID, const bool Human)
   this->Score = 0;
   this->SelectedBase = nullptr;
   this->HomeBase = nullptr;
+  this->FirstBase = nullptr;
+  this->NumBases = 0;
   this->AI = nullptr;
 
   if(!Human) {
     this->AI = (void *) new AIDriver();
 
-    if(!((AIDriver * ) AI)->Create(this)) {
+    if(!((AIDriver * ) AI)->Create(this, Config, AIPhase, AISeed)) {
       delete ((AIDriver *) this->AI);
 
       return false;
@@ -64,12 +80,44 @@ Player::Create(const PlayerID ID, const bool Human)
   return true;
 }
 
+double
+Player::GetSoldiers(void) const
+{
+  double Soldiers = 0.0;
+
+  for(const Base *TargetBase = FirstBase;
+      TargetBase != nullptr; TargetBase = TargetBase->GetNextOwnedBase()) {
+    Soldiers += TargetBase->GetSoldiers();
+  }
+
+  return Soldiers;
+}
+
+void
+Player::RemoveBase(Base *OldBase)
+{
+  if(OldBase->GetPrevOwnedBase() != nullptr) {
+    OldBase->GetPrevOwnedBase()->ChangeNextOwnedBase(OldBase->GetNextOwnedBase());
+  } else {
+    FirstBase = OldBase->GetNextOwnedBase();
+  }
+
+  if(OldBase->GetNextOwnedBase() != nullptr) {
+    OldBase->GetNextOwnedBase()->ChangePrevOwnedBase(OldBase->GetPrevOwnedBase());
+  }
+
+  OldBase->ChangeNextOwnedBase(nullptr);
+  OldBase->ChangePrevOwnedBase(nullptr);
+
+  NumBases--;
+}
+
 void
-Player::Tick(void *MainGame, const double Delta, std::minstd_rand &Rand)
+Player::Tick(void *MainSimulation, const double Delta)
 {
-  Game *MainGame_ = (Game *) MainGame;
+  Simulation *MainSimulation_ = (Simulation *) MainSimulation;
 
   if(AI != nullptr) {
-    ((AIDriver *) AI)->Tick(MainGame_, Delta, Rand);
+    ((AIDriver *) AI)->Tick(MainSimulation_, Delta);
   }
 }
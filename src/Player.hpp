@@ -25,8 +25,8 @@ class Player;
 
 typedef unsigned int PlayerID;
 
-#include <random>
 
+#include "AiConfig.hpp"
 #include "Base.hpp"
 
 class Player {
@@ -38,23 +38,36 @@ private:
   Base *SelectedBase;
   Base *HomeBase;
 
+  // Bases owned by the player, kept up to date by Base::ChangeOwner().
+  Base *FirstBase;
+  int NumBases;
+
   void *AI;
 
 public:
   ~Player(void);
-  Player(void) { }
+  Player(void) { AI = nullptr; }
+  void AddBase(Base *NewBase);
   void ChangeHomeBase(Base *HomeBase);
   void ChangeScore(const int NewScore) { Score = NewScore; }
   void ChangeSelectedBase(Base *SelectedBase);
-  bool Create(const PlayerID ID, const bool Human);
+  bool Create(const PlayerID ID,
+              const bool Human,
+              const AIConfig &Config,
+              const double AIPhase, const unsigned int AISeed);
   void Dead(void) { Alive =  false; }
+  void *GetAI(void) const { return AI; }
+  Base *GetFirstBase(void) const { return FirstBase; }
   Base *GetHomeBase(void) { return HomeBase; }
   PlayerID GetID(void) const { return ID; }
+  int GetNumBases(void) const { return NumBases; }
   int GetScore(void) const { return Score; }
   Base *GetSelectedBase(void) const { return SelectedBase; }
+  double GetSoldiers(void) const;
   bool IsAlive(void) const { return Alive; }
   bool IsHuman(void) const { return Human; }
-  void Tick(void *MainGame, const double Delta, std::minstd_rand &Rand);
+  void RemoveBase(Base *OldBase);
+  void Tick(void *MainSimulation, const double Delta);
 };
 
 #endif /* _PLAYER_HPP_ */
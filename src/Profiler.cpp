@@ -0,0 +1,248 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Profiler.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#define PROFILER_RING_SIZE 8192     // Must be 2**N
+#define PROFILER_MAX_FRAMES 36000   // Frames kept for SaveCSV(), 10 minutes at 60 FPS
+#define PROFILER_MAX_EVENTS 1048576 // Zone times kept for SaveTrace()
+
+struct ProfileEvent {
+  int64_t Start;
+  int64_t End;
+  uint32_t Zone;
+  uint32_t Thread;
+};
+
+// A slot holds the zone time numbered Sequence - 1, or is being written
+// while Sequence is 0.
+struct RingSlot {
+  std::atomic<uint64_t> Sequence;
+  std::atomic<int64_t> Start;
+  std::atomic<int64_t> End;
+  std::atomic<uint32_t> ZoneAndThread;
+};
+
+static const char *ZoneNames[] = {
+  "Loop",
+  "Input",
+  "Tick",
+  "BasesTick",
+  "PlayersTick",
+  "AI",
+  "Draw",
+  "DrawWorld",
+  "DrawOwnerHighlights",
+  "DrawSelectedBase",
+  "DrawHighlight",
+  "DrawLinks",
+  "DrawAttacks",
+  "DrawBaseStatus",
+  "DrawWindow",
+  "Present"
+};
+
+static_assert(sizeof(ZoneNames) / sizeof(ZoneNames[0]) == NUM_PROFILE_ZONES,
+              "Every profile zone needs a name");
+
+std::atomic<bool> Profiler::Enabled(false);
+
+static RingSlot Ring[PROFILER_RING_SIZE];
+static std::atomic<uint64_t> RingHead(0);
+static uint64_t RingTail = 0;
+static std::atomic<uint32_t> NumThreads(0);
+static thread_local const uint32_t ThreadNum = NumThreads++;
+
+static const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+
+// Filled in by EndFrame() on the main thread only.
+static int64_t FrameStart = -1;
+static int NumFrames = 0;
+static double History[PROFILER_HISTORY][NUM_PROFILE_ZONES];
+static std::vector<float> FrameTimes;     // NUM_PROFILE_ZONES per frame, in ms
+static std::vector<ProfileEvent> Events;
+
+static void DrainRing(double *Times);
+
+// Ends the frame that began at the last call, if the profiler was on for
+// all of it, and takes in the zone times recorded since.
+void
+Profiler::EndFrame(void)
+{
+  const int64_t Time = Now();
+  double *Times;
+
+  if(!IsEnabled() || FrameStart < 0) {
+    DrainRing(nullptr);
+    FrameStart = IsEnabled() ? Time : -1;
+
+    return;
+  }
+
+  Times = History[NumFrames % PROFILER_HISTORY];
+  for(int I = 0; I < NUM_PROFILE_ZONES; I++) { Times[I] = 0.0; }
+
+  Times[(int) ProfileZone::Loop] = (Time - FrameStart) / 1000000.0;
+  if(Events.size() < PROFILER_MAX_EVENTS) {
+    Events.push_back({ FrameStart, Time, (uint32_t) ProfileZone::Loop, ThreadNum });
+  }
+
+  DrainRing(Times);
+
+  if(FrameTimes.size() < (size_t) PROFILER_MAX_FRAMES * NUM_PROFILE_ZONES) {
+    FrameTimes.insert(FrameTimes.end(), Times, Times + NUM_PROFILE_ZONES);
+  }
+
+  NumFrames++;
+  FrameStart = Time;
+}
+
+// In milliseconds, 0 for frames no longer kept.
+double
+Profiler::GetFrameTime(const int FramesAgo, const ProfileZone Zone)
+{
+  if(FramesAgo < 0 || FramesAgo >= NumFrames || FramesAgo >= PROFILER_HISTORY) { return 0.0; }
+
+  return History[(NumFrames - 1 - FramesAgo) % PROFILER_HISTORY][(int) Zone];
+}
+
+int
+Profiler::GetNumFrames(void)
+{
+  return NumFrames;
+}
+
+const char *
+Profiler::GetZoneName(const ProfileZone Zone)
+{
+  return ZoneNames[(int) Zone];
+}
+
+// Nanoseconds since the program started.
+int64_t
+Profiler::Now(void)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count();
+}
+
+void
+Profiler::Record(const ProfileZone Zone, const int64_t Start, const int64_t End)
+{
+  const uint64_t Index = RingHead.fetch_add(1, std::memory_order_relaxed);
+  RingSlot &Slot = Ring[Index & (PROFILER_RING_SIZE - 1)];
+
+  Slot.Sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  Slot.Start.store(Start, std::memory_order_relaxed);
+  Slot.End.store(End, std::memory_order_relaxed);
+  Slot.ZoneAndThread.store(((uint32_t) Zone << 16) | (ThreadNum & 0xFFFF), std::memory_order_relaxed);
+
+  Slot.Sequence.store(Index + 1, std::memory_order_release);
+}
+
+// One line per frame with the time of every zone in milliseconds.
+bool
+Profiler::SaveCSV(const char *FileName)
+{
+  FILE *File;
+
+  File = fopen(FileName, "w");
+  if(File == nullptr) { return false; }
+
+  fprintf(File, "Frame");
+  for(int I = 0; I < NUM_PROFILE_ZONES; I++) { fprintf(File, ",%s", ZoneNames[I]); }
+  fprintf(File, "\n");
+
+  for(size_t Frame = 0; Frame * NUM_PROFILE_ZONES < FrameTimes.size(); Frame++) {
+    fprintf(File, "%zu", Frame);
+    for(int I = 0; I < NUM_PROFILE_ZONES; I++) {
+      fprintf(File, ",%.3f", FrameTimes[Frame * NUM_PROFILE_ZONES + I]);
+    }
+    fprintf(File, "\n");
+  }
+
+  return fclose(File) == 0;
+}
+
+// Every zone time as a complete event of the Chrome trace event format,
+// which chrome://tracing and Perfetto open.
+bool
+Profiler::SaveTrace(const char *FileName)
+{
+  FILE *File;
+
+  File = fopen(FileName, "w");
+  if(File == nullptr) { return false; }
+
+  fprintf(File, "{\"traceEvents\":[\n");
+  for(size_t I = 0; I < Events.size(); I++) {
+    const ProfileEvent &Event = Events[I];
+
+    fprintf(File, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+            ZoneNames[Event.Zone], Event.Thread,
+            Event.Start / 1000.0, (Event.End - Event.Start) / 1000.0,
+            (I + 1 < Events.size()) ? "," : "");
+  }
+  fprintf(File, "],\"displayTimeUnit\":\"ms\"}\n");
+
+  return fclose(File) == 0;
+}
+
+// Helper Functions for Profiler
+//
+// Takes the zone times out of the ring, adding them to Times unless it is
+// nullptr.  A time still being written is left for the next frame; times
+// overwritten before they were taken are lost.
+static void
+DrainRing(double *Times)
+{
+  const uint64_t Head = RingHead.load(std::memory_order_acquire);
+
+  if(Head - RingTail > PROFILER_RING_SIZE) { RingTail = Head - PROFILER_RING_SIZE; }
+
+  for(; RingTail < Head; RingTail++) {
+    RingSlot &Slot = Ring[RingTail & (PROFILER_RING_SIZE - 1)];
+    const uint64_t Sequence = Slot.Sequence.load(std::memory_order_acquire);
+    ProfileEvent Event;
+    uint32_t ZoneAndThread;
+
+    if(Sequence < RingTail + 1) { break; }
+    if(Sequence > RingTail + 1) { continue; }
+
+    Event.Start = Slot.Start.load(std::memory_order_relaxed);
+    Event.End = Slot.End.load(std::memory_order_relaxed);
+    ZoneAndThread = Slot.ZoneAndThread.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(Slot.Sequence.load(std::memory_order_relaxed) != Sequence) { continue; }
+
+    Event.Zone = ZoneAndThread >> 16;
+    Event.Thread = ZoneAndThread & 0xFFFF;
+    if(Times == nullptr || Event.Zone >= NUM_PROFILE_ZONES) { continue; }
+
+    Times[Event.Zone] += (Event.End - Event.Start) / 1000000.0;
+    if(Events.size() < PROFILER_MAX_EVENTS) { Events.push_back(Event); }
+  }
+}
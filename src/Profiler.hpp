@@ -0,0 +1,94 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _PROFILER_HPP_
+#define _PROFILER_HPP_
+
+class Profiler;
+
+#include <atomic>
+#include <cstdint>
+
+#include "Debug.hpp"
+
+enum class ProfileZone {
+  Loop,
+  Input,
+  Tick,
+  BasesTick,
+  PlayersTick,
+  AI,
+  Draw,
+  DrawWorld,
+  DrawOwnerHighlights,
+  DrawSelectedBase,
+  DrawHighlight,
+  DrawLinks,
+  DrawAttacks,
+  DrawBaseStatus,
+  DrawWindow,
+  Present,
+  NumZones
+};
+
+#define NUM_PROFILE_ZONES ((int) ProfileZone::NumZones)
+#define PROFILER_HISTORY 128 // Frames kept for the on screen graph
+
+// Times named zones of the code while switched on.  A zone may be timed
+// from any thread: its times go into a lock-free ring that EndFrame()
+// empties on the main thread once a frame.  The frames and zone times
+// seen while it was on are written out by SaveCSV() and SaveTrace().
+//
+// With ENABLE_PROFILER set to 0 in Debug.hpp, PROFILE_ZONE() is nothing.
+class Profiler {
+private:
+  static std::atomic<bool> Enabled;
+public:
+  static void ChangeEnabled(const bool Value) { Enabled.store(Value, std::memory_order_relaxed); }
+  static void EndFrame(void);
+  static double GetFrameTime(const int FramesAgo, const ProfileZone Zone);
+  static int GetNumFrames(void);
+  static const char *GetZoneName(const ProfileZone Zone);
+  static bool IsEnabled(void) { return Enabled.load(std::memory_order_relaxed); }
+  static int64_t Now(void);
+  static void Record(const ProfileZone Zone, const int64_t Start, const int64_t End);
+  static bool SaveCSV(const char *FileName);
+  static bool SaveTrace(const char *FileName);
+};
+
+// Times the rest of the block it is made in.
+class ScopedZone {
+private:
+  ProfileZone Zone;
+  int64_t Start;
+public:
+  ~ScopedZone(void) { if(Start >= 0) { Profiler::Record(Zone, Start, Profiler::Now()); } }
+  ScopedZone(const ProfileZone Zone) : Zone(Zone), Start(Profiler::IsEnabled() ? Profiler::Now() : -1) { }
+};
+
+#if ENABLE_PROFILER
+#define PROFILE_ZONE_NAME2(Line) ProfileZone_##Line
+#define PROFILE_ZONE_NAME(Line) PROFILE_ZONE_NAME2(Line)
+#define PROFILE_ZONE(Zone) ScopedZone PROFILE_ZONE_NAME(__LINE__)(ProfileZone::Zone)
+#else
+#define PROFILE_ZONE(Zone)
+#endif // ENABLE_PROFILER
+
+#endif // _PROFILER_HPP_
@@ -0,0 +1,447 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Replay.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "Simulation.hpp"
+
+#define REPLAY_VERSION 9
+
+// The kinds of entries in the stream after the command types.
+#define REPLAY_ENTRY_HASH     5
+#define REPLAY_ENTRY_END      6
+#define REPLAY_ENTRY_AI_DELAY 7
+
+static void PutU16(std::vector<uint8_t> &Buffer, const uint16_t Value);
+static void PutU32(std::vector<uint8_t> &Buffer, const uint32_t Value);
+static void PutU64(std::vector<uint8_t> &Buffer, const uint64_t Value);
+static bool ReadU16(const uint8_t *&Pos, const uint8_t *End, uint16_t &Value);
+static bool ReadU32(const uint8_t *&Pos, const uint8_t *End, uint32_t &Value);
+static bool ReadU64(const uint8_t *&Pos, const uint8_t *End, uint64_t &Value);
+static bool ReadVarInt(const uint8_t *&Pos, const uint8_t *End, uint64_t &Value);
+
+bool
+Replay::Create(const WorldSettings &Settings,
+               const unsigned int Seed,
+               const int DifficultyValue,
+               const bool HasHumanPlayer,
+               const int TickRate,
+               const int HashInterval, const AIConfig *Configs)
+{
+  if(TickRate < 1 || HashInterval < 1) { return false; }
+
+  this->Seed = Seed;
+  this->DifficultyValue = DifficultyValue;
+  this->HasHumanPlayer = HasHumanPlayer;
+  this->TickRate = TickRate;
+  this->HashInterval = HashInterval;
+  this->Settings = Settings;
+
+  this->Configs.resize(Settings.NumPlayers);
+  for(int I = 0; I < Settings.NumPlayers; I++) {
+    this->Configs[I] = (Configs != nullptr) ? Configs[I] : Simulation::GetDefaultAIConfig(DifficultyValue);
+  }
+
+  Stream.clear();
+  LastTick = 0;
+  EndTick = -1;
+
+  return true;
+}
+
+void
+Replay::Finish(const long long Tick, const uint64_t Hash)
+{
+  if(EndTick >= 0) { return; }
+
+  WriteEntry(REPLAY_ENTRY_END, Tick);
+  WriteHash(Hash);
+  EndTick = Tick;
+}
+
+bool
+Replay::Load(const char *FileName)
+{
+  std::vector<uint8_t> Buffer;
+  const uint8_t *Pos, *End;
+  uint32_t Seed, HashInterval, StreamSize;
+  uint32_t SizeX, SizeY, NumBases, NumPlayers;
+  uint16_t TickRate;
+  FILE *ReplayFile;
+  long FileSize;
+
+  ReplayFile = fopen(FileName, "rb");
+  if(ReplayFile == nullptr) { return false; }
+
+  if(fseek(ReplayFile, 0, SEEK_END) != 0 || (FileSize = ftell(ReplayFile)) < 0 ||
+     fseek(ReplayFile, 0, SEEK_SET) != 0) {
+    fclose(ReplayFile);
+
+    return false;
+  }
+
+  Buffer.resize((size_t) FileSize);
+  if(fread(Buffer.data(), 1, Buffer.size(), ReplayFile) != Buffer.size()) {
+    fclose(ReplayFile);
+
+    return false;
+  }
+
+  fclose(ReplayFile);
+
+  Pos = Buffer.data();
+  End = Pos + Buffer.size();
+
+  if(End - Pos < 8) { return false; }
+  if(memcmp(Pos, "bcr", 3) != 0 || Pos[3] != REPLAY_VERSION) { return false; }
+
+  DifficultyValue = Pos[4];
+  HasHumanPlayer = Pos[5] != 0;
+  Pos += 6;
+
+  if(!ReadU16(Pos, End, TickRate))     { return false; }
+  if(!ReadU32(Pos, End, Seed))         { return false; }
+  if(!ReadU32(Pos, End, HashInterval)) { return false; }
+  if(!ReadU32(Pos, End, SizeX))        { return false; }
+  if(!ReadU32(Pos, End, SizeY))        { return false; }
+  if(!ReadU32(Pos, End, NumBases))     { return false; }
+  if(!ReadU32(Pos, End, NumPlayers))   { return false; }
+
+  if(DifficultyValue > 4 || TickRate < 1 || HashInterval < 1) { return false; }
+  if(SizeX > 65536 || SizeY > 65536 || NumBases > (1 << 24))  { return false; }
+  if(NumPlayers > MAX_PLAYERS)                                { return false; }
+
+  this->Seed = Seed;
+  this->TickRate = TickRate;
+  this->HashInterval = (int) HashInterval;
+  this->Settings.SizeX = (int) SizeX;
+  this->Settings.SizeY = (int) SizeY;
+  this->Settings.NumBases = (int) NumBases;
+  this->Settings.NumPlayers = (int) NumPlayers;
+
+  if(!World::CheckSettings(Settings)) { return false; }
+
+  Configs.resize(NumPlayers);
+  for(int I = 0; I < (int) NumPlayers; I++) {
+    uint64_t DecisionTime;
+    uint32_t Attack, Colonize, Unlink, Planner;
+    double Seconds;
+
+    if(!ReadU64(Pos, End, DecisionTime)) { return false; }
+    if(!ReadU32(Pos, End, Attack))       { return false; }
+    if(!ReadU32(Pos, End, Colonize))     { return false; }
+    if(!ReadU32(Pos, End, Unlink))       { return false; }
+    if(!ReadU32(Pos, End, Planner))      { return false; }
+
+    memcpy(&Seconds, &DecisionTime, sizeof(double));
+
+    if(!std::isfinite(Seconds) || !(Seconds > 0.0)) { return false; }
+    if(Attack < 2 || Colonize < 1 || Unlink < 1)    { return false; }
+    if(Planner >= NUM_AI_PLANNERS)                  { return false; }
+
+    Configs[I].DecisionTime = Seconds;
+    Configs[I].ChanceToAttack = Attack;
+    Configs[I].ChanceToColonize = Colonize;
+    Configs[I].ChanceToUnlinkBase = Unlink;
+    Configs[I].Planner = (AIPlanner) Planner;
+  }
+
+  if(!ReadU32(Pos, End, StreamSize))     { return false; }
+  if((size_t) (End - Pos) != StreamSize) { return false; }
+
+  Stream.assign(Pos, End);
+  LastTick = 0;
+  EndTick = -1;
+
+  return true;
+}
+
+// Runs the match again as fast as possible, giving every command on the
+// tick it was recorded on and comparing the state hashes on the way.  An
+// entry past REPLAY_MAX_TIME is taken as broken, rather than ticked up to.
+bool
+Replay::Play(ReplayResult &Result) const
+{
+  const double Delta = 1.0 / (double) TickRate;
+  const long long MaxTicks = (long long) TickRate * REPLAY_MAX_TIME;
+  const uint8_t *Pos = Stream.data();
+  const uint8_t *End = Pos + Stream.size();
+
+  Simulation Match;
+  long long Tick = 0;
+
+  Result.Ticks = 0;
+  Result.HashesChecked = 0;
+  Result.DesyncTick = -1;
+  Result.CommandsRun = 0;
+
+  if(!Match.Create(Settings, DifficultyValue, HasHumanPlayer, Seed, Configs.data())) {
+    return false;
+  }
+
+  while(Pos < End) {
+    const int Kind = *Pos++;
+    uint64_t TickDelta;
+
+    if(!ReadVarInt(Pos, End, TickDelta))           { return false; }
+    if(TickDelta > (uint64_t) (MaxTicks - Tick)) { return false; }
+
+    Tick += (long long) TickDelta;
+    while(Match.GetTickCount() < Tick) { Match.Tick(Delta); }
+
+    switch(Kind) {
+    case (int) CommandType::Attack:
+    case (int) CommandType::Colonize:
+    case (int) CommandType::Link:
+    case (int) CommandType::Unlink:
+    case (int) CommandType::Route: {
+      uint64_t PlayerNum, SrcBase, TargetBase;
+      Command NewCommand;
+
+      if(!ReadVarInt(Pos, End, PlayerNum))  { return false; }
+      if(!ReadVarInt(Pos, End, SrcBase))    { return false; }
+      if(!ReadVarInt(Pos, End, TargetBase)) { return false; }
+
+      if(PlayerNum >= (uint64_t) Settings.NumPlayers)             { return false; }
+      if(SrcBase >= (uint64_t) Match.GetWorld()->GetNumBases())   { return false; }
+      if(TargetBase > (uint64_t) Match.GetWorld()->GetNumBases()) { return false; }
+
+      NewCommand.Type = (CommandType) Kind;
+      NewCommand.PlayerNum = (int) PlayerNum;
+      NewCommand.SrcBase = (int) SrcBase;
+      NewCommand.TargetBase = (int) TargetBase - 1;
+
+      Match.RunCommand(NewCommand);
+      Result.CommandsRun++;
+      break;
+    }
+    case REPLAY_ENTRY_AI_DELAY: {
+      uint64_t PlayerNum;
+
+      if(!ReadVarInt(Pos, End, PlayerNum))            { return false; }
+      if(PlayerNum >= (uint64_t) Settings.NumPlayers) { return false; }
+
+      Match.DelayAIPlan((int) PlayerNum);
+      break;
+    }
+    case REPLAY_ENTRY_HASH:
+    case REPLAY_ENTRY_END: {
+      uint64_t Hash;
+
+      if(!ReadU64(Pos, End, Hash)) { return false; }
+
+      Result.HashesChecked++;
+      if(Result.DesyncTick < 0 && Hash != Match.GetStateHash()) {
+        Result.DesyncTick = Tick;
+      }
+
+      if(Kind == REPLAY_ENTRY_END) {
+        Result.Ticks = Tick;
+
+        return true;
+      }
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+
+  // The replay was cut off before the end of the match.
+  return false;
+}
+
+void
+Replay::RecordAIDelay(const long long Tick, const int PlayerNum)
+{
+  if(EndTick >= 0) { return; }
+
+  WriteEntry(REPLAY_ENTRY_AI_DELAY, Tick);
+  WriteVarInt((uint64_t) PlayerNum);
+}
+
+void
+Replay::RecordCommand(const long long Tick, const Command &NewCommand)
+{
+  if(EndTick >= 0) { return; }
+
+  WriteEntry((int) NewCommand.Type, Tick);
+  WriteVarInt((uint64_t) NewCommand.PlayerNum);
+  WriteVarInt((uint64_t) NewCommand.SrcBase);
+  WriteVarInt((uint64_t) (NewCommand.TargetBase + 1));
+}
+
+void
+Replay::RecordHash(const long long Tick, const uint64_t Hash)
+{
+  if(EndTick >= 0) { return; }
+
+  WriteEntry(REPLAY_ENTRY_HASH, Tick);
+  WriteHash(Hash);
+}
+
+bool
+Replay::Save(const char *FileName) const
+{
+  std::vector<uint8_t> Buffer;
+  FILE *ReplayFile;
+  bool Success;
+
+  Buffer.push_back('b');
+  Buffer.push_back('c');
+  Buffer.push_back('r');
+  Buffer.push_back(REPLAY_VERSION);
+  Buffer.push_back((uint8_t) DifficultyValue);
+  Buffer.push_back(HasHumanPlayer ? 1 : 0);
+  PutU16(Buffer, (uint16_t) TickRate);
+  PutU32(Buffer, Seed);
+  PutU32(Buffer, (uint32_t) HashInterval);
+  PutU32(Buffer, (uint32_t) Settings.SizeX);
+  PutU32(Buffer, (uint32_t) Settings.SizeY);
+  PutU32(Buffer, (uint32_t) Settings.NumBases);
+  PutU32(Buffer, (uint32_t) Settings.NumPlayers);
+
+  for(int I = 0; I < Settings.NumPlayers; I++) {
+    uint64_t DecisionTime;
+
+    memcpy(&DecisionTime, &Configs[I].DecisionTime, sizeof(double));
+    PutU64(Buffer, DecisionTime);
+    PutU32(Buffer, Configs[I].ChanceToAttack);
+    PutU32(Buffer, Configs[I].ChanceToColonize);
+    PutU32(Buffer, Configs[I].ChanceToUnlinkBase);
+    PutU32(Buffer, (uint32_t) Configs[I].Planner);
+  }
+
+  PutU32(Buffer, (uint32_t) Stream.size());
+  Buffer.insert(Buffer.end(), Stream.begin(), Stream.end());
+
+  ReplayFile = fopen(FileName, "wb");
+  if(ReplayFile == nullptr) { return false; }
+
+  Success = fwrite(Buffer.data(), 1, Buffer.size(), ReplayFile) == Buffer.size();
+  Success = (fclose(ReplayFile) == 0) && Success;
+
+  return Success;
+}
+
+// Private Functions of Replay
+void
+Replay::WriteEntry(const int Kind, const long long Tick)
+{
+  Stream.push_back((uint8_t) Kind);
+  WriteVarInt((uint64_t) (Tick - LastTick));
+  LastTick = Tick;
+}
+
+void
+Replay::WriteHash(const uint64_t Hash)
+{
+  PutU64(Stream, Hash);
+}
+
+void
+Replay::WriteVarInt(uint64_t Value)
+{
+  while(Value >= 0x80) {
+    Stream.push_back((uint8_t) (Value | 0x80));
+    Value >>= 7;
+  }
+
+  Stream.push_back((uint8_t) Value);
+}
+
+static void
+PutU16(std::vector<uint8_t> &Buffer, const uint16_t Value)
+{
+  Buffer.push_back((uint8_t) Value);
+  Buffer.push_back((uint8_t) (Value >> 8));
+}
+
+static void
+PutU32(std::vector<uint8_t> &Buffer, const uint32_t Value)
+{
+  PutU16(Buffer, (uint16_t) Value);
+  PutU16(Buffer, (uint16_t) (Value >> 16));
+}
+
+static void
+PutU64(std::vector<uint8_t> &Buffer, const uint64_t Value)
+{
+  PutU32(Buffer, (uint32_t) Value);
+  PutU32(Buffer, (uint32_t) (Value >> 32));
+}
+
+static bool
+ReadU16(const uint8_t *&Pos, const uint8_t *End, uint16_t &Value)
+{
+  if(End - Pos < 2) { return false; }
+
+  Value = (uint16_t) (Pos[0] | (Pos[1] << 8));
+  Pos += 2;
+
+  return true;
+}
+
+static bool
+ReadU32(const uint8_t *&Pos, const uint8_t *End, uint32_t &Value)
+{
+  uint16_t Low, High;
+
+  if(!ReadU16(Pos, End, Low))  { return false; }
+  if(!ReadU16(Pos, End, High)) { return false; }
+
+  Value = (uint32_t) Low | ((uint32_t) High << 16);
+
+  return true;
+}
+
+static bool
+ReadU64(const uint8_t *&Pos, const uint8_t *End, uint64_t &Value)
+{
+  uint32_t Low, High;
+
+  if(!ReadU32(Pos, End, Low))  { return false; }
+  if(!ReadU32(Pos, End, High)) { return false; }
+
+  Value = (uint64_t) Low | ((uint64_t) High << 32);
+
+  return true;
+}
+
+static bool
+ReadVarInt(const uint8_t *&Pos, const uint8_t *End, uint64_t &Value)
+{
+  Value = 0;
+
+  for(int Shift = 0; Shift < 64; Shift += 7) {
+    if(Pos == End) { return false; }
+
+    const uint8_t Byte = *Pos++;
+
+    Value |= (uint64_t) (Byte & 0x7F) << Shift;
+    if(!(Byte & 0x80)) { return true; }
+  }
+
+  return false;
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _REPLAY_HPP_
+#define _REPLAY_HPP_
+
+class Replay;
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AiConfig.hpp"
+#include "Config.hpp"
+#include "World.hpp"
+
+class Simulation;
+
+// A player action, with the bases given by their index in the world.
+enum class CommandType {
+  Attack,   // Attack TargetBase from SrcBase, or call the attack off
+  Colonize, // Colonize TargetBase from SrcBase
+  Link,     // Link SrcBase to TargetBase, or unlink them
+  Unlink,   // Remove the link of SrcBase
+  Route     // Link the bases around SrcBase towards it
+};
+
+struct Command {
+  CommandType Type;
+  int PlayerNum;
+  int SrcBase;
+  int TargetBase; // -1 for no base
+};
+
+struct ReplayResult {
+  long long Ticks;
+  int HashesChecked;
+  long long DesyncTick; // First tick whose state hash differs, -1 if none
+  int CommandsRun;
+};
+
+// A match as its seed, settings and the player commands, each keyed by
+// the simulation tick it was given on, along with the ticks an AI put a
+// late plan off on.  The commands are stored as a byte
+// stream of tick deltas and variable length integers, with a hash of the
+// simulation state every HashInterval ticks to catch desyncs on playback.
+class Replay {
+private:
+  unsigned int Seed;
+  int DifficultyValue;
+  bool HasHumanPlayer;
+  int TickRate;
+  int HashInterval;
+  WorldSettings Settings;
+  std::vector<AIConfig> Configs; // One per player
+
+  std::vector<uint8_t> Stream;
+  long long LastTick;
+  long long EndTick;
+
+  void WriteEntry(const int Kind, const long long Tick);
+  void WriteHash(const uint64_t Hash);
+  void WriteVarInt(uint64_t Value);
+public:
+  Replay(void) { }
+  ~Replay(void) { }
+  bool Create(const WorldSettings &Settings,
+              const unsigned int Seed,
+              const int DifficultyValue,
+              const bool HasHumanPlayer,
+              const int TickRate,
+              const int HashInterval, const AIConfig *Configs);
+  void Finish(const long long Tick, const uint64_t Hash);
+  int GetDifficulty(void) const { return DifficultyValue; }
+  long long GetEndTick(void) const { return EndTick; }
+  int GetHashInterval(void) const { return HashInterval; }
+  unsigned int GetSeed(void) const { return Seed; }
+  const WorldSettings &GetSettings(void) const { return Settings; }
+  size_t GetStreamSize(void) const { return Stream.size(); }
+  int GetTickRate(void) const { return TickRate; }
+  bool Load(const char *FileName);
+  bool Play(ReplayResult &Result) const;
+  void RecordAIDelay(const long long Tick, const int PlayerNum);
+  void RecordCommand(const long long Tick, const Command &NewCommand);
+  void RecordHash(const long long Tick, const uint64_t Hash);
+  bool Save(const char *FileName) const;
+};
+
+#endif // _REPLAY_HPP_
@@ -60,14 +60,14 @@ CreateScoreWindow(Game *MainGame, VideoDriver *Video)
   ScoreWindow->Center(WindowWidth, WindowHeight);
 
   LongestName = 0;
-  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) {
+  for(int I = 0; I < MainGame->GetNumPlayers(); I++) {
     size_t NameLength;
 
     NameLength = strlen(PlayerNames[I]);
     if(NameLength > LongestName) { LongestName = NameLength; }
   }
 
-  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) {
+  for(int I = 0; I < MainGame->GetNumPlayers(); I++) {
     const Player *TargetPlayer = MainGame->GetPlayer(I);
     Label *NewLabel;
     char Buffer2[256];
@@ -0,0 +1,947 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include "Ai.hpp"
+#include "Profiler.hpp"
+#include "Snapshot.hpp"
+
+static bool CheckSnapshot(const uint8_t *Data, const size_t Size);
+static bool CheckSnapshotSection(const uint64_t Offset,
+                                 const uint64_t Count,
+                                 const size_t RecordSize, const size_t Size);
+static unsigned int GetAISeed(const unsigned int Seed, const int PlayerNum);
+static int GetBaseIndex(const Base *TargetBase);
+static uint64_t HashBytes(uint64_t Hash, const void *Data, const size_t Size);
+
+Simulation::~Simulation(void)
+{
+  // The AIs wait for their plans, which read the world, as they go.
+  delete[] Players;
+  delete GameWorld;
+}
+
+bool
+Simulation::AttackBase(Base *SrcBase, Base *TargetBase)
+{
+  if(!SrcBase->AttackBase(TargetBase, Rand)) { return false; }
+
+  if(TargetBase != nullptr && AttackSignal != nullptr) {
+    AttackSignal(this, SignalArg);
+  }
+
+  return true;
+}
+
+void
+Simulation::ChangeAttackSignal(void (*Signal)(void *, void *), void *Arg)
+{
+  SignalArg = Arg;
+  AttackSignal = Signal;
+}
+
+// AIConfigs holds one configuration per player, or is null for the
+// default one.
+bool
+Simulation::Create(const WorldSettings &Settings,
+                   const int DifficultyValue,
+                   const bool HasHumanPlayer,
+                   const unsigned int Seed, const AIConfig *AIConfigs)
+{
+  this->DifficultyValue = DifficultyValue;
+  this->Rand.seed(Seed);
+  this->TickCount = 0;
+  this->Recorder = nullptr;
+  this->SignalArg = nullptr;
+  this->AttackSignal = nullptr;
+  this->AISnapshotTick = -1;
+
+  GameWorld = new World();
+
+  // A match's world is small enough to generate on the calling thread,
+  // which may itself be a worker of a pool.
+  if(!GameWorld->Create(Settings, Rand, nullptr)) {
+    delete GameWorld;
+
+    GameWorld = nullptr;
+
+    return false;
+  }
+
+  GameWorld->GetBaseTable()->ChangeAIGrowthModifier(GetAIGrowthModifier(DifficultyValue));
+
+  CreatePlayers(Settings.NumPlayers, HasHumanPlayer, AIConfigs, (unsigned int) Rand());
+  AssignPlayerBases();
+
+  return true;
+}
+
+// Puts the plan of an AI off a tick, as the match a replay recorded did.
+void
+Simulation::DelayAIPlan(const int PlayerNum)
+{
+  AIDriver *AI = (AIDriver *) Players[PlayerNum].GetAI();
+
+  if(AI != nullptr) { AI->DelayPlan(); }
+}
+
+void
+Simulation::FindNewHomeBase(Player *TargetPlayer)
+{
+  Base *LargestBase = nullptr;
+
+  for(Base *TargetBase = TargetPlayer->GetFirstBase();
+      TargetBase != nullptr; TargetBase = TargetBase->GetNextOwnedBase()) {
+    if(LargestBase == nullptr) {
+      LargestBase = TargetBase;
+    } else if(LargestBase->GetSize() < TargetBase->GetSize()) {
+      LargestBase = TargetBase;
+    }
+  }
+
+  TargetPlayer->ChangeHomeBase(LargestBase);
+}
+
+// The state of every base for the AIs that start planning on this tick.
+// It is made once a tick at most and shared, and is never changed after.
+std::shared_ptr<const std::vector<AIBaseState>>
+Simulation::GetAISnapshot(void)
+{
+  std::shared_ptr<std::vector<AIBaseState>> NewSnapshot;
+
+  if(AISnapshot != nullptr && AISnapshotTick == TickCount) { return AISnapshot; }
+
+  NewSnapshot = std::make_shared<std::vector<AIBaseState>>(GameWorld->GetNumBases());
+  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
+    const Base *TargetBase = GameWorld->GetBase(I);
+    AIBaseState &State = (*NewSnapshot)[I];
+
+    State.Soldiers = TargetBase->GetSoldiers();
+    State.Owner = (TargetBase->GetOwner() != nullptr) ? (int) TargetBase->GetOwner()->GetID() - 1 : -1;
+    State.TargetBase = GetBaseIndex(TargetBase->GetTargetBase());
+    State.AttackingBase = GetBaseIndex(TargetBase->GetAttackingBase());
+    State.IncomingAttacks = TargetBase->GetIncomingAttacks();
+    State.Size = TargetBase->GetSize();
+    State.Growth = GameWorld->GetBaseTable()->GetGrowth(I);
+    State.Roll = (4.0 + (double) TargetBase->GetAttackRoll()) / (4.0 + (double) TargetBase->GetDefenseRoll());
+    State.Front = GameWorld->GetSupplyGraph()->GetFront(I);
+    State.Supply = GameWorld->GetSupplyGraph()->GetSupply(I);
+  }
+
+  AISnapshot = NewSnapshot;
+  AISnapshotTick = TickCount;
+
+  return AISnapshot;
+}
+
+// The AIs of a match that was not given its own configurations.  Only
+// the hardest difficulty plays its moves out before making them.
+AIConfig
+Simulation::GetDefaultAIConfig(const int DifficultyValue)
+{
+  AIConfig Config = DefaultAIConfig;
+
+  if(DifficultyValue >= 4) { Config.Planner = AIPlanner::MonteCarlo; }
+
+  return Config;
+}
+
+int
+Simulation::GetNumPlayersAlive(void) const
+{
+  int NumPlayersAlive = 0;
+
+  for(int I = 0; I < NumPlayers; I++) {
+    if(Players[I].IsAlive()) { NumPlayersAlive++; }
+  }
+
+  return NumPlayersAlive;
+}
+
+Player *
+Simulation::GetPlayer(const int I)
+{
+  if(I < 0 || I >= NumPlayers) { return nullptr; }
+
+  return &Players[I];
+}
+
+// A hash of everything that decides how the match goes on, to check that
+// a replay is still in step with the match it was recorded from.
+uint64_t
+Simulation::GetStateHash(void)
+{
+  std::minstd_rand RandCopy = Rand;
+  const unsigned int RandValue = (unsigned int) RandCopy();
+  uint64_t Hash = 0xCBF29CE484222325ULL;
+
+  Hash = HashBytes(Hash, &TickCount, sizeof(TickCount));
+  Hash = HashBytes(Hash, &RandValue, sizeof(RandValue));
+
+  for(int I = 0; I < GameWorld->GetNumBases(); I++) {
+    const Base *TargetBase = GameWorld->GetBase(I);
+    const PlayerID Owner = (TargetBase->GetOwner() != nullptr) ? TargetBase->GetOwner()->GetID() : 0;
+    const int TargetIndex = (TargetBase->GetTargetBase() != nullptr) ? TargetBase->GetTargetBase()->GetIndex() : -1;
+    const int AttackingIndex = (TargetBase->GetAttackingBase() != nullptr) ? TargetBase->GetAttackingBase()->GetIndex() : -1;
+    const double Soldiers = TargetBase->GetSoldiers();
+    const int Size = TargetBase->GetSize();
+
+    Hash = HashBytes(Hash, &Owner, sizeof(Owner));
+    Hash = HashBytes(Hash, &Soldiers, sizeof(Soldiers));
+    Hash = HashBytes(Hash, &Size, sizeof(Size));
+    Hash = HashBytes(Hash, &TargetIndex, sizeof(TargetIndex));
+    Hash = HashBytes(Hash, &AttackingIndex, sizeof(AttackingIndex));
+  }
+
+  for(int I = 0; I < NumPlayers; I++) {
+    const bool Alive = Players[I].IsAlive();
+    const int Score = Players[I].GetScore();
+
+    Hash = HashBytes(Hash, &Alive, sizeof(Alive));
+    Hash = HashBytes(Hash, &Score, sizeof(Score));
+  }
+
+  return Hash;
+}
+
+Player *
+Simulation::GetWinner(void)
+{
+  Player *Winner = nullptr;
+
+  for(int I = 0; I < NumPlayers; I++) {
+    if(Players[I].IsAlive()) {
+      if(Winner != nullptr) { return nullptr; }
+
+      Winner = &Players[I];
+    }
+  }
+
+  return Winner;
+}
+
+// Loads a game saved with Save() into a simulation that has not been
+// created.  The file is mapped and its records are read in place; the
+// indices in them are turned back into pointers as the bases and players
+// are rebuilt.  A loaded match is not recorded for a replay.
+bool
+Simulation::Load(const char *FileName)
+{
+  const SnapshotHeader *Header;
+  const SnapshotBase *SavedBases;
+  const SnapshotPlayer *SavedPlayers;
+  const SnapshotCommand *SavedCommands;
+  std::vector<AIConfig> AIConfigs;
+  std::vector<Command> AIPlan;
+  std::vector<Base *> OwnedBases;
+  MappedFile File;
+  const uint8_t *Data;
+
+  this->GameWorld = nullptr;
+
+  if(!File.Create(FileName))                         { return false; }
+  if(!CheckSnapshot(File.GetData(), File.GetSize())) { return false; }
+
+  Data = File.GetData();
+  Header = (const SnapshotHeader *) Data;
+  SavedBases = (const SnapshotBase *) (Data + Header->BasesOffset);
+  SavedPlayers = (const SnapshotPlayer *) (Data + Header->PlayersOffset);
+  SavedCommands = (const SnapshotCommand *) (Data + Header->CommandsOffset);
+
+  this->DifficultyValue = Header->DifficultyValue;
+  this->Rand.seed(Header->RandState);
+  this->TickCount = Header->TickCount;
+  this->Recorder = nullptr;
+  this->SignalArg = nullptr;
+  this->AttackSignal = nullptr;
+  this->AISnapshotTick = -1;
+
+  GameWorld = new World();
+
+  if(!GameWorld->CreateEmpty(Header->SizeX, Header->SizeY, Header->NumBases)) { goto Error; }
+  if(!GameWorld->UnpackTiles(Data + Header->TilesOffset))                      { goto Error; }
+
+  for(int I = 0; I < Header->NumBases; I++) {
+    const SnapshotBase &Saved = SavedBases[I];
+
+    GameWorld->RestoreBase(I, Saved.LocX, Saved.LocY, Saved.ID, Saved.Size, Saved.DefenceValue);
+  }
+
+  if(!GameWorld->FinishRestore()) { goto Error; }
+
+  GameWorld->GetBaseTable()->ChangeAIGrowthModifier(GetAIGrowthModifier(DifficultyValue));
+
+  AIConfigs.resize(Header->NumPlayers);
+  for(int I = 0; I < Header->NumPlayers; I++) {
+    AIConfigs[I].DecisionTime = SavedPlayers[I].DecisionTime;
+    AIConfigs[I].ChanceToAttack = SavedPlayers[I].ChanceToAttack;
+    AIConfigs[I].ChanceToColonize = SavedPlayers[I].ChanceToColonize;
+    AIConfigs[I].ChanceToUnlinkBase = SavedPlayers[I].ChanceToUnlinkBase;
+    AIConfigs[I].Planner = (AIPlanner) SavedPlayers[I].Planner;
+  }
+
+  CreatePlayers(Header->NumPlayers, Header->HumanPlayer == 0, AIConfigs.data(), 0);
+
+  // Rebuild every player's list of bases in the saved order, which the AI
+  // walks through, by adding them to the front from the back.
+  for(int I = 0; I < NumPlayers; I++) {
+    OwnedBases.clear();
+
+    for(int J = SavedPlayers[I].FirstBase; J >= 0; J = SavedBases[J].NextOwnedBase) {
+      if(SavedBases[J].Owner != I)                        { goto Error; }
+      if(OwnedBases.size() == (size_t) Header->NumBases) { goto Error; }
+
+      OwnedBases.push_back(GameWorld->GetBase(J));
+    }
+
+    for(size_t J = OwnedBases.size(); J > 0; J--) {
+      OwnedBases[J - 1]->ChangeOwner(&Players[I]);
+    }
+  }
+
+  for(int I = 0; I < Header->NumBases; I++) {
+    const SnapshotBase &Saved = SavedBases[I];
+    Base *TargetBase = GameWorld->GetBase(I);
+
+    // Every owned base must have been on its owner's list.
+    if(Saved.Owner >= 0 && TargetBase->GetOwner() != &Players[Saved.Owner]) { goto Error; }
+
+    TargetBase->ChangeSoldiers(Saved.Soldiers);
+    if(!TargetBase->RestoreTargets(GameWorld->GetBase(Saved.TargetBase),
+                                   GameWorld->GetBase(Saved.AttackingBase),
+                                   Saved.AttackRoll, Saved.DefenseRoll)) {
+      goto Error;
+    }
+  }
+
+  for(int I = 0; I < NumPlayers; I++) {
+    const SnapshotPlayer &Saved = SavedPlayers[I];
+
+    Players[I].ChangeScore(Saved.Score);
+    Players[I].ChangeSelectedBase(GameWorld->GetBase(Saved.SelectedBase));
+    Players[I].ChangeHomeBase(GameWorld->GetBase(Saved.HomeBase));
+    if(!Saved.Alive) { Players[I].Dead(); }
+
+    if(Players[I].GetAI() != nullptr) {
+      AIDriver *AI = (AIDriver *) Players[I].GetAI();
+
+      AIPlan.resize(Saved.AINumCommands);
+      for(int J = 0; J < Saved.AINumCommands; J++) {
+        const SnapshotCommand &SavedCommand = SavedCommands[Saved.AIFirstCommand + J];
+
+        AIPlan[J].Type = (CommandType) SavedCommand.Type;
+        AIPlan[J].PlayerNum = I;
+        AIPlan[J].SrcBase = SavedCommand.SrcBase;
+        AIPlan[J].TargetBase = SavedCommand.TargetBase;
+      }
+
+      AI->ChangeTicks(Saved.AITicks);
+      AI->ChangeRandState(Saved.AIRandState);
+      AI->ChangePlan(AIPlan.data(), Saved.AINumCommands);
+    }
+  }
+
+  return true;
+Error:
+  delete GameWorld;
+
+  GameWorld = nullptr;
+
+  return false;
+}
+
+// Runs a player action and records it for the replay.  Actions that are
+// not allowed are ignored, as they are when coming from the input.
+void
+Simulation::RecordAIDelay(const int PlayerNum)
+{
+  if(Recorder != nullptr) { Recorder->RecordAIDelay(TickCount, PlayerNum); }
+}
+
+bool
+Simulation::RunCommand(const Command &NewCommand)
+{
+  const int NumBases = GameWorld->GetNumBases();
+
+  Player *TargetPlayer;
+  Base *SrcBase, *TargetBase;
+
+  if(NewCommand.PlayerNum < 0 || NewCommand.PlayerNum >= NumPlayers) { return false; }
+  if(NewCommand.SrcBase < 0 || NewCommand.SrcBase >= NumBases)              { return false; }
+  if(NewCommand.TargetBase < -1 || NewCommand.TargetBase >= NumBases)       { return false; }
+
+  TargetPlayer = &Players[NewCommand.PlayerNum];
+  SrcBase = GameWorld->GetBase(NewCommand.SrcBase);
+  TargetBase = (NewCommand.TargetBase >= 0) ? GameWorld->GetBase(NewCommand.TargetBase) : nullptr;
+
+  if(SrcBase->GetOwner() != TargetPlayer) { return false; }
+
+  if(Recorder != nullptr) { Recorder->RecordCommand(TickCount, NewCommand); }
+
+  switch(NewCommand.Type) {
+  case CommandType::Attack:
+    if(TargetBase != nullptr) { CommandAttack(SrcBase, TargetBase); }
+    break;
+  case CommandType::Colonize:
+    if(TargetBase != nullptr) { CommandColonize(TargetPlayer, SrcBase, TargetBase); }
+    break;
+  case CommandType::Link:
+    if(TargetBase != nullptr) { CommandLink(SrcBase, TargetBase); }
+    break;
+  case CommandType::Unlink:
+    SrcBase->ChangeTargetBase(nullptr);
+    break;
+  case CommandType::Route:
+    CommandRoute(SrcBase);
+    break;
+  default:
+    abort();
+  }
+
+  return true;
+}
+
+// Writes the whole state of the match in one go, see Snapshot.hpp for the
+// layout of the file.
+bool
+Simulation::Save(const char *FileName)
+{
+  const int NumBases = GameWorld->GetNumBases();
+  const size_t TilesOffset = sizeof(SnapshotHeader);
+  const size_t BasesOffset = (TilesOffset + GameWorld->GetPackedTilesSize() + 7) & ~(size_t) 7;
+  const size_t PlayersOffset = BasesOffset + (NumBases * sizeof(SnapshotBase));
+  const size_t CommandsOffset = PlayersOffset + (NumPlayers * sizeof(SnapshotPlayer));
+  const int NumCommands = CountAICommands();
+  const size_t FileSize = CommandsOffset + (NumCommands * sizeof(SnapshotCommand));
+
+  // Zeroed and 8 byte aligned, like the records need to be.
+  std::vector<uint64_t> Buffer((FileSize + 7) / 8, 0);
+  uint8_t *Data = (uint8_t *) Buffer.data();
+  SnapshotHeader *Header = (SnapshotHeader *) Data;
+  SnapshotBase *SavedBases = (SnapshotBase *) (Data + BasesOffset);
+  SnapshotPlayer *SavedPlayers = (SnapshotPlayer *) (Data + PlayersOffset);
+  SnapshotCommand *SavedCommands = (SnapshotCommand *) (Data + CommandsOffset);
+  int NextCommand = 0;
+  std::stringstream RandState;
+  unsigned long State;
+  FILE *SaveFile;
+  bool Success;
+
+  RandState << Rand;
+  RandState >> State;
+
+  memcpy(Header->Magic, "bcs", 4);
+  Header->Version = SNAPSHOT_VERSION;
+  Header->HeaderSize = sizeof(SnapshotHeader);
+  Header->ByteOrder = SNAPSHOT_BYTE_ORDER;
+  Header->FileSize = FileSize;
+  GameWorld->GetSize(Header->SizeX, Header->SizeY);
+  Header->NumBases = NumBases;
+  Header->NumPlayers = NumPlayers;
+  Header->DifficultyValue = DifficultyValue;
+  Header->HumanPlayer = (HumanPlayer != nullptr) ? (int32_t) (HumanPlayer->GetID() - 1) : -1;
+  Header->TickCount = TickCount;
+  Header->RandState = (uint32_t) State;
+  Header->NumCommands = NumCommands;
+  Header->TilesOffset = TilesOffset;
+  Header->BasesOffset = BasesOffset;
+  Header->PlayersOffset = PlayersOffset;
+  Header->CommandsOffset = CommandsOffset;
+
+  GameWorld->PackTiles(Data + TilesOffset);
+
+  for(int I = 0; I < NumBases; I++) {
+    const Base *TargetBase = GameWorld->GetBase(I);
+    SnapshotBase &Saved = SavedBases[I];
+
+    Saved.Soldiers = TargetBase->GetSoldiers();
+    TargetBase->GetLoc(Saved.LocX, Saved.LocY);
+    Saved.Size = TargetBase->GetSize();
+    Saved.DefenceValue = TargetBase->GetDefenceValue();
+    Saved.ID = TargetBase->GetID();
+    Saved.Owner = (TargetBase->GetOwner() != nullptr) ? (int32_t) (TargetBase->GetOwner()->GetID() - 1) : -1;
+    Saved.NextOwnedBase = GetBaseIndex(TargetBase->GetNextOwnedBase());
+    Saved.TargetBase = GetBaseIndex(TargetBase->GetTargetBase());
+    Saved.AttackingBase = GetBaseIndex(TargetBase->GetAttackingBase());
+    Saved.AttackRoll = TargetBase->GetAttackRoll();
+    Saved.DefenseRoll = TargetBase->GetDefenseRoll();
+  }
+
+  for(int I = 0; I < NumPlayers; I++) {
+    AIDriver *AI = (AIDriver *) Players[I].GetAI();
+    const AIConfig &Config = (AI != nullptr) ? AI->GetConfig() : DefaultAIConfig;
+    SnapshotPlayer &Saved = SavedPlayers[I];
+
+    Saved.AITicks = (AI != nullptr) ? AI->GetTicks() : 0.0;
+    Saved.AIRandState = (AI != nullptr) ? AI->GetRandState() : 1;
+    Saved.AIFirstCommand = NextCommand;
+    Saved.AINumCommands = 0;
+    if(AI != nullptr) {
+      const std::vector<Command> &Plan = AI->GetPlan();
+
+      for(size_t J = 0; J < Plan.size(); J++) {
+        SnapshotCommand &SavedCommand = SavedCommands[NextCommand++];
+
+        SavedCommand.Type = (int32_t) Plan[J].Type;
+        SavedCommand.SrcBase = Plan[J].SrcBase;
+        SavedCommand.TargetBase = Plan[J].TargetBase;
+      }
+
+      Saved.AINumCommands = (int32_t) Plan.size();
+    }
+    Saved.DecisionTime = Config.DecisionTime;
+    Saved.ChanceToAttack = Config.ChanceToAttack;
+    Saved.ChanceToColonize = Config.ChanceToColonize;
+    Saved.ChanceToUnlinkBase = Config.ChanceToUnlinkBase;
+    Saved.Planner = (uint8_t) Config.Planner;
+    Saved.Score = Players[I].GetScore();
+    Saved.FirstBase = GetBaseIndex(Players[I].GetFirstBase());
+    Saved.SelectedBase = GetBaseIndex(Players[I].GetSelectedBase());
+    Saved.HomeBase = GetBaseIndex(Players[I].GetHomeBase());
+    Saved.Human = Players[I].IsHuman() ? 1 : 0;
+    Saved.Alive = Players[I].IsAlive() ? 1 : 0;
+  }
+
+  SaveFile = fopen(FileName, "wb");
+  if(SaveFile == nullptr) { return false; }
+
+  Success = fwrite(Data, 1, FileSize, SaveFile) == FileSize;
+  Success = (fclose(SaveFile) == 0) && Success;
+
+  return Success;
+}
+
+void
+Simulation::Tick(const double Delta)
+{
+  BasesTick(Delta);
+  PlayersTick(Delta);
+  CheckIfPlayersAreAlive();
+
+  TickCount++;
+  if(Recorder != nullptr && TickCount % Recorder->GetHashInterval() == 0) {
+    Recorder->RecordHash(TickCount, GetStateHash());
+  }
+}
+
+// Private Functions of Simulation
+void
+Simulation::AssignPlayerBases(void)
+{
+  std::vector<Player *> PlayersToAssignBases(NumPlayers);
+
+  for(int I = 0; I < NumPlayers; I++) {
+  AssignAgain:
+    PlayersToAssignBases[I] = &Players[Rand() % NumPlayers];
+
+    for(int J = 0; J < I; J++) {
+      if(PlayersToAssignBases[J]->GetID() == PlayersToAssignBases[I]->GetID()) {
+        goto AssignAgain;
+      }
+    }
+  }
+
+  // Every player starts in a region of their own.
+  for(int I = 0; I < NumPlayers; I++) {
+    int FirstBase, NumRegionBases;
+
+    GameWorld->GetRegionBases(I, FirstBase, NumRegionBases);
+
+    Base *TargetBase = GameWorld->GetBase(FirstBase + (Rand() % NumRegionBases));
+
+    if(TargetBase->GetOwner() != nullptr) { abort(); }
+
+    TargetBase->ChangeOwner(PlayersToAssignBases[I]);
+    if(TargetBase->GetSize() < 5) {
+      TargetBase->ChangeSize(5); // Give the player a fighting chance.
+    }
+
+    TargetBase->ChangeSoldiers(10.0);
+
+    if(PlayersToAssignBases[I]->IsHuman()) {
+      PlayersToAssignBases[I]->ChangeHomeBase(TargetBase);
+    }
+  }
+}
+
+void
+Simulation::BasesTick(const double Delta)
+{
+  PROFILE_ZONE(BasesTick);
+
+  BaseTable *Table = GameWorld->GetBaseTable();
+
+  Table->Grow(Delta);
+
+  // Only the bases with a link or an attack have anything else to do.
+  for(int I = Table->GetNextActive(0); I >= 0; I = Table->GetNextActive(I + 1)) {
+    GameWorld->GetBase(I)->Tick(Delta, Rand);
+  }
+
+  CheckHomeBases();
+}
+
+void
+Simulation::CheckHomeBases(void)
+{
+  /* Find a new home base for any player whose home base has been conquered
+     by another player. */
+  for(int I = 0; I < NumPlayers; I++) {
+    Player *TargetPlayer = &Players[I];
+    const Base *HomeBase = TargetPlayer->GetHomeBase();
+
+    if(HomeBase != nullptr && HomeBase->GetOwner() != TargetPlayer) {
+      FindNewHomeBase(TargetPlayer);
+    }
+  }
+}
+
+void
+Simulation::CheckIfPlayersAreAlive(void)
+{
+  for(int I = 0; I < NumPlayers; I++) {
+    if(Players[I].GetNumBases() == 0) { Players[I].Dead(); }
+  }
+}
+
+void
+Simulation::CommandAttack(Base *SrcBase, Base *TargetBase)
+{
+  // Attacking the base under attack again calls the attack off.
+  if(SrcBase->GetAttackingBase() == TargetBase) {
+    Player *TargetPlayer = TargetBase->GetOwner();
+
+    if(TargetPlayer != nullptr) { TargetPlayer->ChangeScore(TargetPlayer->GetScore() + 1); }
+    AttackBase(SrcBase, nullptr);
+  } else if(TargetBase->GetOwner() != nullptr && TargetBase->GetOwner() != SrcBase->GetOwner()) {
+    AttackBase(SrcBase, TargetBase);
+  }
+}
+
+void
+Simulation::CommandColonize(Player *TargetPlayer, Base *SrcBase, Base *TargetBase)
+{
+  const int Distance = SrcBase->GetDistanceToBase(TargetBase);
+
+  if(SrcBase->GetSoldiers() > 10.0 && Distance <= MAX_BASE_DISTANCE) {
+    TargetBase->Colonize(TargetPlayer, SrcBase);
+  }
+}
+
+void
+Simulation::CommandLink(Base *SrcBase, Base *DstBase)
+{
+  const int Distance = SrcBase->GetDistanceToBase(DstBase);
+
+  // Unlink the two base if they are already linked together.
+  if(SrcBase->GetTargetBase() != nullptr) {
+    if(SrcBase->GetTargetBase()->GetID() == DstBase->GetID()) {
+      SrcBase->ChangeTargetBase(nullptr);
+    }
+  } else {
+    // Check if the destination base has a linked base.
+    if(DstBase->GetTargetBase() != nullptr) {
+      // If destination base linked to the source base, then unlinked them both.
+      if(DstBase->GetTargetBase()->GetID() == SrcBase->GetID()) {
+        DstBase->ChangeTargetBase(nullptr);
+      } else {
+        if(Distance <= MAX_BASE_DISTANCE) { SrcBase->ChangeTargetBase(DstBase); }
+      }
+    } else {
+      if(Distance <= MAX_BASE_DISTANCE) { SrcBase->ChangeTargetBase(DstBase); }
+    }
+  }
+}
+
+// Links the bases of the player that reach DstBase through its other bases
+// towards it, each to the base it is first reached from, so DstBase gets
+// the soldiers of all of them.  Bases that are fighting keep their soldiers
+// and nothing is routed through them, and bases whose links already end at
+// DstBase are left as they are.
+void
+Simulation::CommandRoute(Base *DstBase)
+{
+  const SupplyGraph *Supply = GameWorld->GetSupplyGraph();
+  const int Front = DstBase->GetIndex();
+  std::vector<uint8_t> Reached(GameWorld->GetNumBases(), 0);
+  std::vector<Base *> Queue;
+
+  DstBase->ChangeTargetBase(nullptr);
+  Reached[Front] = 1;
+  Queue.push_back(DstBase);
+
+  for(size_t I = 0; I < Queue.size(); I++) {
+    const BaseNeighbour *Neighbours;
+    int NumNeighbours;
+
+    Neighbours = Queue[I]->GetNeighbours(NumNeighbours);
+    for(int J = 0; J < NumNeighbours; J++) {
+      Base *NextBase = Neighbours[J].NeighbourBase;
+
+      if(Reached[Neighbours[J].NeighbourIndex])       { continue; }
+      if(NextBase->GetOwner() != DstBase->GetOwner()) { continue; }
+      if(NextBase->IsAttacking())                     { continue; }
+      if(NextBase->GetIncomingAttacks() > 0)          { continue; }
+
+      // The base linked to is already on the route, which the new one
+      // is not, so the link can not close a loop.
+      Reached[Neighbours[J].NeighbourIndex] = 1;
+      if(Supply->GetFront(Neighbours[J].NeighbourIndex) != Front) {
+        NextBase->ChangeTargetBase(Queue[I]);
+      }
+
+      Queue.push_back(NextBase);
+    }
+  }
+}
+
+// How many commands the AI plans waiting to be carried out hold.
+int
+Simulation::CountAICommands(void)
+{
+  int NumCommands = 0;
+
+  for(int I = 0; I < NumPlayers; I++) {
+    AIDriver *AI = (AIDriver *) Players[I].GetAI();
+
+    if(AI != nullptr) { NumCommands += (int) AI->GetPlan().size(); }
+  }
+
+  return NumCommands;
+}
+
+void
+Simulation::CreatePlayers(const int NumPlayers,
+                          const bool HasHumanPlayer,
+                          const AIConfig *AIConfigs, const unsigned int AISeed)
+{
+  this->NumPlayers = NumPlayers;
+  this->Players = new Player[NumPlayers];
+
+  const AIConfig DifficultyConfig = GetDefaultAIConfig(DifficultyValue);
+
+  for(int I = 0; I < NumPlayers; I++) {
+    const AIConfig &Config = (AIConfigs != nullptr) ? AIConfigs[I] : DifficultyConfig;
+    const double AIPhase = (double) I / NumPlayers;
+    const unsigned int PlayerSeed = GetAISeed(AISeed, I);
+
+    if(I == 0 && HasHumanPlayer) {
+      Players[I].Create(I + 1, true, Config, AIPhase, PlayerSeed);
+    } else {
+      Players[I].Create(I + 1, false, Config, AIPhase, PlayerSeed);
+    }
+  }
+
+  HumanPlayer = (HasHumanPlayer) ? &Players[0] : nullptr;
+}
+
+double
+Simulation::GetAIGrowthModifier(const int DifficultyValue)
+{
+  switch(DifficultyValue) {
+  case 0:
+    return 0.5;
+  case 1:
+    return 0.75;
+  case 2:
+    return 1.0;
+  case 3:
+    return 1.15;
+  case 4:
+    return 1.3;
+  default:
+    abort();
+  }
+}
+
+void
+Simulation::PlayersTick(const double Delta)
+{
+  PROFILE_ZONE(PlayersTick);
+
+  for(int I = 0; I < NumPlayers; I++) {
+    Players[I].Tick(this, Delta);
+  }
+}
+
+// Checks that a saved game is complete and that every index in it is in
+// range, before anything is built from it.
+static bool
+CheckSnapshot(const uint8_t *Data, const size_t Size)
+{
+  const SnapshotHeader *Header = (const SnapshotHeader *) Data;
+  const SnapshotBase *SavedBases;
+  const SnapshotPlayer *SavedPlayers;
+  const SnapshotCommand *SavedCommands;
+  size_t TilesEnd, BasesEnd, PlayersEnd;
+
+  if(Size < sizeof(SnapshotHeader)) { return false; }
+
+  if(memcmp(Header->Magic, "bcs", 4) != 0)          { return false; }
+  if(Header->Version != SNAPSHOT_VERSION)          { return false; }
+  if(Header->HeaderSize != sizeof(SnapshotHeader)) { return false; }
+  if(Header->ByteOrder != SNAPSHOT_BYTE_ORDER)     { return false; }
+  if(Header->FileSize != Size)                     { return false; }
+
+  if(Header->SizeX < 1 || Header->SizeX > 65536)                 { return false; }
+  if(Header->SizeY < 1 || Header->SizeY > 65536)                 { return false; }
+  if((int64_t) Header->SizeX * Header->SizeY > (1 << 28))        { return false; }
+  if(Header->NumBases < 1 || Header->NumBases > (1 << 24))       { return false; }
+  if(Header->NumPlayers < 1 || Header->NumPlayers > MAX_PLAYERS) { return false; }
+  if(Header->DifficultyValue < 0 || Header->DifficultyValue > 4) { return false; }
+  if(Header->HumanPlayer < -1 || Header->HumanPlayer > 0)        { return false; }
+  if(Header->TickCount < 0)                                      { return false; }
+  if(Header->RandState < 1 || Header->RandState >= 2147483647)   { return false; }
+  if(Header->NumCommands < 0)                                    { return false; }
+
+  // The offsets come from the file, so each section is checked to fit
+  // before its end is worked out, which then can not overflow.
+  if(!CheckSnapshotSection(Header->TilesOffset,
+                           ((uint64_t) Header->SizeX * Header->SizeY + 1) / 2, 1, Size)) {
+    return false;
+  }
+  if(!CheckSnapshotSection(Header->BasesOffset,
+                           Header->NumBases, sizeof(SnapshotBase), Size)) {
+    return false;
+  }
+  if(!CheckSnapshotSection(Header->PlayersOffset,
+                           Header->NumPlayers, sizeof(SnapshotPlayer), Size)) {
+    return false;
+  }
+  if(!CheckSnapshotSection(Header->CommandsOffset,
+                           Header->NumCommands, sizeof(SnapshotCommand), Size)) {
+    return false;
+  }
+
+  TilesEnd = Header->TilesOffset + (((size_t) Header->SizeX * Header->SizeY + 1) / 2);
+  BasesEnd = Header->BasesOffset + (Header->NumBases * sizeof(SnapshotBase));
+  PlayersEnd = Header->PlayersOffset + (Header->NumPlayers * sizeof(SnapshotPlayer));
+
+  if(Header->TilesOffset != sizeof(SnapshotHeader))                          { return false; }
+  if(Header->BasesOffset > Header->PlayersOffset)                            { return false; }
+  if(Header->PlayersOffset > Header->CommandsOffset)                         { return false; }
+  if(Header->BasesOffset % 8 != 0 || Header->BasesOffset < TilesEnd)         { return false; }
+  if(Header->PlayersOffset % 8 != 0 || Header->PlayersOffset < BasesEnd)     { return false; }
+  if(Header->CommandsOffset % 8 != 0 || Header->CommandsOffset < PlayersEnd) { return false; }
+  if(Header->CommandsOffset + (Header->NumCommands * sizeof(SnapshotCommand)) != Size) {
+    return false;
+  }
+
+  SavedBases = (const SnapshotBase *) (Data + Header->BasesOffset);
+  SavedPlayers = (const SnapshotPlayer *) (Data + Header->PlayersOffset);
+  SavedCommands = (const SnapshotCommand *) (Data + Header->CommandsOffset);
+
+  for(int I = 0; I < Header->NumBases; I++) {
+    const SnapshotBase &Saved = SavedBases[I];
+
+    if(!std::isfinite(Saved.Soldiers) || Saved.Soldiers < 0.0)              { return false; }
+    if(Saved.LocX < 0 || Saved.LocX >= Header->SizeX)                       { return false; }
+    if(Saved.LocY < 0 || Saved.LocY >= Header->SizeY)                       { return false; }
+    if(Saved.Size < 1)                                                      { return false; }
+    if(Saved.Owner < -1 || Saved.Owner >= Header->NumPlayers)               { return false; }
+    if(Saved.NextOwnedBase < -1 || Saved.NextOwnedBase >= Header->NumBases) { return false; }
+    if(Saved.TargetBase < -1 || Saved.TargetBase >= Header->NumBases)       { return false; }
+    if(Saved.AttackingBase < -1 || Saved.AttackingBase >= Header->NumBases) { return false; }
+  }
+
+  for(int I = 0; I < Header->NumPlayers; I++) {
+    const SnapshotPlayer &Saved = SavedPlayers[I];
+
+    if(!std::isfinite(Saved.DecisionTime) || !(Saved.DecisionTime > 0.0)) { return false; }
+    if(Saved.ChanceToAttack < 2 || Saved.ChanceToColonize < 1)            { return false; }
+    if(Saved.ChanceToUnlinkBase < 1)                                      { return false; }
+    if(Saved.Planner >= NUM_AI_PLANNERS)                                  { return false; }
+    if(Saved.FirstBase < -1 || Saved.FirstBase >= Header->NumBases)       { return false; }
+    if(Saved.SelectedBase < -1 || Saved.SelectedBase >= Header->NumBases) { return false; }
+    if(Saved.HomeBase < -1 || Saved.HomeBase >= Header->NumBases)         { return false; }
+    if(Saved.AIRandState < 1 || Saved.AIRandState >= 2147483647)          { return false; }
+    if(Saved.AIFirstCommand < 0 || Saved.AINumCommands < 0)               { return false; }
+    if(Saved.AINumCommands > Header->NumCommands - Saved.AIFirstCommand)  { return false; }
+  }
+
+  for(int I = 0; I < Header->NumCommands; I++) {
+    const SnapshotCommand &Saved = SavedCommands[I];
+
+    if(Saved.Type < 0 || Saved.Type > (int32_t) CommandType::Unlink)         { return false; }
+    if(Saved.SrcBase < 0 || Saved.SrcBase >= Header->NumBases)               { return false; }
+    if(Saved.TargetBase < -1 || Saved.TargetBase >= Header->NumBases)        { return false; }
+    if(Saved.Type == (int32_t) CommandType::Colonize && Saved.TargetBase < 0) { return false; }
+  }
+
+  return true;
+}
+
+// Whether Count records of RecordSize bytes from Offset fit in a file of
+// Size bytes.
+static bool
+CheckSnapshotSection(const uint64_t Offset,
+                     const uint64_t Count,
+                     const size_t RecordSize, const size_t Size)
+{
+  if(Offset > Size) { return false; }
+
+  return Count <= (Size - Offset) / RecordSize;
+}
+
+// Every AI draws its own random numbers, as it may plan on another
+// thread, from a seed mixed from the match's and its player number.
+static unsigned int
+GetAISeed(const unsigned int Seed, const int PlayerNum)
+{
+  uint64_t Value;
+
+  // SplitMix64 of the seed and the player number.
+  Value = ((uint64_t) Seed << 32) ^ (uint32_t) PlayerNum;
+  Value += 0x9E3779B97F4A7C15ULL;
+  Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBULL;
+  Value ^= Value >> 31;
+
+  return (unsigned int) (Value >> 32);
+}
+
+static int
+GetBaseIndex(const Base *TargetBase)
+{
+  return (TargetBase != nullptr) ? TargetBase->GetIndex() : -1;
+}
+
+static uint64_t
+HashBytes(uint64_t Hash, const void *Data, const size_t Size)
+{
+  const unsigned char *Bytes = (const unsigned char *) Data;
+
+  // FNV-1a
+  for(size_t I = 0; I < Size; I++) {
+    Hash ^= Bytes[I];
+    Hash *= 0x100000001B3ULL;
+  }
+
+  return Hash;
+}
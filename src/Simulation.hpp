@@ -0,0 +1,125 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _SIMULATION_HPP_
+#define _SIMULATION_HPP_
+
+class Simulation;
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "AiConfig.hpp"
+#include "Base.hpp"
+#include "Config.hpp"
+#include "Player.hpp"
+#include "Replay.hpp"
+#include "ThreadPool.hpp"
+#include "World.hpp"
+
+// A base as the AIs see it when they plan, see GetAISnapshot().
+struct AIBaseState {
+  double Soldiers;
+  int Owner;           // Player number, -1 for none
+  int TargetBase;      // -1 for none
+  int AttackingBase;   // -1 for none
+  int IncomingAttacks;
+  int Size;
+  double Growth;       // Soldiers a second
+  double Roll;         // Damage per soldier of the attack, if any
+  int Front;           // Base its links end at, itself when unlinked
+  double Supply;       // Soldiers a second its links bring it once settled
+};
+
+class Simulation {
+private:
+  int DifficultyValue;
+  std::minstd_rand Rand;
+  long long TickCount;
+  World *GameWorld;
+  Replay *Recorder;
+
+  // The AIs plan on AIPool, or on the simulation's thread without one.
+  // The last snapshot is shared by the AIs that start planning on a tick.
+  // With DelayLateAIPlans, a plan the pool has not finished when it is
+  // due is put off instead of waited for, and the recorder notes it.
+  ThreadPool *AIPool;
+  bool DelayLateAIPlans;
+  std::shared_ptr<const std::vector<AIBaseState>> AISnapshot;
+  long long AISnapshotTick;
+
+  Player *HumanPlayer;
+  Player *Players;
+  int NumPlayers;
+
+  void *SignalArg;
+  void (*AttackSignal)(void *Simulation, void *Arg);
+
+  void AssignPlayerBases(void);
+  void BasesTick(const double Delta);
+  void CheckHomeBases(void);
+  void CheckIfPlayersAreAlive(void);
+  void CommandAttack(Base *SrcBase, Base *TargetBase);
+  void CommandColonize(Player *TargetPlayer, Base *SrcBase, Base *TargetBase);
+  void CommandLink(Base *SrcBase, Base *DstBase);
+  void CommandRoute(Base *DstBase);
+  int CountAICommands(void);
+  void CreatePlayers(const int NumPlayers,
+                     const bool HasHumanPlayer,
+                     const AIConfig *AIConfigs, const unsigned int AISeed);
+  static double GetAIGrowthModifier(const int DifficultyValue);
+  void PlayersTick(const double Delta);
+public:
+  ~Simulation(void);
+  Simulation(void) { GameWorld = nullptr; Players = nullptr; NumPlayers = 0; AIPool = nullptr; DelayLateAIPlans = false; }
+  bool AttackBase(Base *SrcBase, Base *TargetBase);
+  void ChangeAIPool(ThreadPool *AIPool) { this->AIPool = AIPool; }
+  void ChangeAttackSignal(void (*Signal)(void *, void *), void *Arg);
+  void ChangeDelayLateAIPlans(const bool Delay) { DelayLateAIPlans = Delay; }
+  void ChangeRecorder(Replay *Recorder) { this->Recorder = Recorder; }
+  bool Create(const WorldSettings &Settings,
+              const int DifficultyValue,
+              const bool HasHumanPlayer,
+              const unsigned int Seed, const AIConfig *AIConfigs);
+  void DelayAIPlan(const int PlayerNum);
+  void FindNewHomeBase(Player *TargetPlayer);
+  ThreadPool *GetAIPool(void) const { return AIPool; }
+  std::shared_ptr<const std::vector<AIBaseState>> GetAISnapshot(void);
+  static AIConfig GetDefaultAIConfig(const int DifficultyValue);
+  bool GetDelayLateAIPlans(void) const { return DelayLateAIPlans; }
+  int GetDifficulty(void) const { return DifficultyValue; }
+  Player *GetHumanPlayer(void) { return HumanPlayer; }
+  int GetNumPlayers(void) const { return NumPlayers; }
+  int GetNumPlayersAlive(void) const;
+  Player *GetPlayer(const int I);
+  uint64_t GetStateHash(void);
+  long long GetTickCount(void) const { return TickCount; }
+  Player *GetWinner(void);
+  World *GetWorld(void) { return GameWorld; }
+  bool Load(const char *FileName);
+  void RecordAIDelay(const int PlayerNum);
+  bool RunCommand(const Command &NewCommand);
+  bool Save(const char *FileName);
+  void Tick(const double Delta);
+};
+
+#endif // _SIMULATION_HPP_
@@ -0,0 +1,96 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Snapshot.hpp"
+
+#include <cstdio>
+
+#if !__WIN32__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // !__WIN32__
+
+MappedFile::~MappedFile(void)
+{
+#if __WIN32__
+  delete[] (const uint64_t *) Data;
+#else
+  if(Data != nullptr) { munmap((void *) Data, Size); }
+#endif // __WIN32__
+}
+
+bool
+MappedFile::Create(const char *FileName)
+{
+#if __WIN32__
+  uint64_t *Buffer;
+  FILE *File;
+  long FileSize;
+
+  File = fopen(FileName, "rb");
+  if(File == nullptr) { return false; }
+
+  if(fseek(File, 0, SEEK_END) != 0 || (FileSize = ftell(File)) <= 0 ||
+     fseek(File, 0, SEEK_SET) != 0) {
+    fclose(File);
+
+    return false;
+  }
+
+  // Keep the records 8 byte aligned, as they are read in place.
+  Buffer = new uint64_t[(FileSize + 7) / 8];
+  Data = (const uint8_t *) Buffer;
+  if(fread(Buffer, 1, (size_t) FileSize, File) != (size_t) FileSize) {
+    fclose(File);
+
+    return false;
+  }
+
+  fclose(File);
+
+  Size = (size_t) FileSize;
+
+  return true;
+#else
+  struct stat FileStat;
+  void *Map;
+  int File;
+
+  File = open(FileName, O_RDONLY);
+  if(File < 0) { return false; }
+
+  if(fstat(File, &FileStat) != 0 || FileStat.st_size <= 0) {
+    close(File);
+
+    return false;
+  }
+
+  Map = mmap(nullptr, (size_t) FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+  close(File);
+  if(Map == MAP_FAILED) { return false; }
+
+  Data = (const uint8_t *) Map;
+  Size = (size_t) FileStat.st_size;
+
+  return true;
+#endif // __WIN32__
+}
@@ -0,0 +1,120 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _SNAPSHOT_HPP_
+#define _SNAPSHOT_HPP_
+
+class MappedFile;
+
+#include <cstddef>
+#include <cstdint>
+
+// A saved game is a header followed by four sections, each starting on
+// an 8 byte boundary: the tiles packed two to a byte, one SnapshotBase per
+// base, one SnapshotPlayer per player and the SnapshotCommands of the AI
+// plans waiting to be carried out.  Bases and players refer to each
+// other by index, and -1 stands for none.  The records are read in place
+// from the mapped file, so their layout is part of the format.
+#define SNAPSHOT_VERSION    4
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+
+struct SnapshotHeader {
+  char Magic[4];         // "bcs"
+  uint32_t Version;
+  uint32_t HeaderSize;
+  uint32_t ByteOrder;    // SNAPSHOT_BYTE_ORDER as written by the saving machine
+  uint64_t FileSize;
+  int32_t SizeX;
+  int32_t SizeY;
+  int32_t NumBases;
+  int32_t NumPlayers;
+  int32_t DifficultyValue;
+  int32_t HumanPlayer;
+  int64_t TickCount;
+  uint32_t RandState;
+  int32_t NumCommands;
+  uint64_t TilesOffset;
+  uint64_t BasesOffset;
+  uint64_t PlayersOffset;
+  uint64_t CommandsOffset;
+};
+
+struct SnapshotBase {
+  double Soldiers;
+  int32_t LocX;
+  int32_t LocY;
+  int32_t Size;
+  int32_t DefenceValue;
+  uint32_t ID;
+  int32_t Owner;
+  int32_t NextOwnedBase;
+  int32_t TargetBase;
+  int32_t AttackingBase;
+  int32_t AttackRoll;
+  int32_t DefenseRoll;
+  int32_t Reserved;
+};
+
+struct SnapshotPlayer {
+  double AITicks;
+  double DecisionTime;
+  uint32_t ChanceToAttack;
+  uint32_t ChanceToColonize;
+  uint32_t ChanceToUnlinkBase;
+  int32_t Score;
+  int32_t FirstBase;
+  int32_t SelectedBase;
+  int32_t HomeBase;
+  uint32_t AIRandState;
+  int32_t AIFirstCommand; // The player's plan in the commands section
+  int32_t AINumCommands;
+  uint8_t Human;
+  uint8_t Alive;
+  uint8_t Planner; // AIPlanner
+  uint8_t Reserved[5];
+};
+
+struct SnapshotCommand {
+  int32_t Type; // CommandType
+  int32_t SrcBase;
+  int32_t TargetBase;
+  int32_t Reserved;
+};
+
+static_assert(sizeof(SnapshotHeader) == 96, "SnapshotHeader layout changed");
+static_assert(sizeof(SnapshotBase) == 56, "SnapshotBase layout changed");
+static_assert(sizeof(SnapshotPlayer) == 64, "SnapshotPlayer layout changed");
+static_assert(sizeof(SnapshotCommand) == 16, "SnapshotCommand layout changed");
+
+// A whole file mapped read only into memory, or read into a buffer where
+// mapping is not available.
+class MappedFile {
+private:
+  const uint8_t *Data;
+  size_t Size;
+public:
+  MappedFile(void) { Data = nullptr; Size = 0; }
+  ~MappedFile(void);
+  bool Create(const char *FileName);
+  const uint8_t *GetData(void) const { return Data; }
+  size_t GetSize(void) const { return Size; }
+};
+
+#endif // _SNAPSHOT_HPP_
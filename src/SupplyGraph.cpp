@@ -0,0 +1,230 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SupplyGraph.hpp"
+
+#include <cmath>
+#include <cstdlib>
+
+#include "Config.hpp"
+
+SupplyGraph::SupplyGraph(void)
+{
+  NumBases = 0;
+  Parent = nullptr;
+  FirstChild = nullptr;
+  NextSibling = nullptr;
+  PrevSibling = nullptr;
+  Front = nullptr;
+  In = nullptr;
+  Out = nullptr;
+  Dirty = nullptr;
+  Growth = nullptr;
+  Flow = nullptr;
+}
+
+SupplyGraph::~SupplyGraph(void)
+{
+  delete[] Parent;
+  delete[] FirstChild;
+  delete[] NextSibling;
+  delete[] PrevSibling;
+  delete[] Front;
+  delete[] In;
+  delete[] Out;
+  delete[] Dirty;
+  delete[] Growth;
+  delete[] Flow;
+}
+
+// Whether linking Index to TargetIndex leaves the links without a loop,
+// which it does unless TargetIndex is Index or one of the bases behind it.
+bool
+SupplyGraph::CanLink(const int Index, const int TargetIndex)
+{
+  const int Root = Front[Index];
+
+  if(Front[TargetIndex] != Root) { return true; }
+  if(Dirty[Root])                 { Number(Root); }
+
+  return (In[TargetIndex] < In[Index] || In[TargetIndex] >= Out[Index]);
+}
+
+void
+SupplyGraph::ChangeGrowth(const int Index, const double Value)
+{
+  const int64_t NewGrowth = (int64_t) std::llround(Value * SUPPLY_FLOW_SCALE);
+  const int64_t Delta = NewGrowth - Growth[Index];
+
+  Growth[Index] = NewGrowth;
+  AddFlow(Index, Delta);
+}
+
+// Moves Index, and the bases behind it, over to TargetIndex, or makes it
+// a front of its own if TargetIndex is -1.  See CanLink().
+void
+SupplyGraph::ChangeLink(const int Index, const int TargetIndex)
+{
+  const int OldParent = Parent[Index];
+
+  if(OldParent == TargetIndex) { return; }
+  if(TargetIndex >= 0 && !CanLink(Index, TargetIndex)) { abort(); }
+
+  if(OldParent >= 0) {
+    AddFlow(OldParent, -Flow[Index]);
+
+    if(PrevSibling[Index] >= 0) {
+      NextSibling[PrevSibling[Index]] = NextSibling[Index];
+    } else {
+      FirstChild[OldParent] = NextSibling[Index];
+    }
+    if(NextSibling[Index] >= 0) { PrevSibling[NextSibling[Index]] = PrevSibling[Index]; }
+
+    Parent[Index] = -1;
+    NextSibling[Index] = -1;
+    PrevSibling[Index] = -1;
+
+    // Taking bases out of a tree leaves the numbers of the rest in order,
+    // and the ones taken out keep theirs.
+    Dirty[Index] = Dirty[Front[Index]];
+    ChangeFront(Index, Index);
+  }
+
+  if(TargetIndex >= 0) {
+    Parent[Index] = TargetIndex;
+    NextSibling[Index] = FirstChild[TargetIndex];
+    if(FirstChild[TargetIndex] >= 0) { PrevSibling[FirstChild[TargetIndex]] = Index; }
+    FirstChild[TargetIndex] = Index;
+
+    AddFlow(TargetIndex, Flow[Index]);
+    ChangeFront(Index, Front[TargetIndex]);
+    Dirty[Front[TargetIndex]] = 1;
+  }
+}
+
+bool
+SupplyGraph::Create(const int NumBases)
+{
+  this->NumBases = NumBases;
+
+  Parent = new int[NumBases];
+  FirstChild = new int[NumBases];
+  NextSibling = new int[NumBases];
+  PrevSibling = new int[NumBases];
+  Front = new int[NumBases];
+  In = new int[NumBases];
+  Out = new int[NumBases];
+  Dirty = new uint8_t[NumBases];
+  Growth = new int64_t[NumBases];
+  Flow = new int64_t[NumBases];
+  if(Parent == nullptr || FirstChild == nullptr || NextSibling == nullptr ||
+     PrevSibling == nullptr || Front == nullptr || In == nullptr ||
+     Out == nullptr || Dirty == nullptr || Growth == nullptr || Flow == nullptr) {
+    return false;
+  }
+
+  for(int I = 0; I < NumBases; I++) {
+    Parent[I] = -1;
+    FirstChild[I] = -1;
+    NextSibling[I] = -1;
+    PrevSibling[I] = -1;
+    Front[I] = I;
+    In[I] = 0;
+    Out[I] = 1;
+    Dirty[I] = 0;
+    Growth[I] = 0;
+    Flow[I] = 0;
+  }
+
+  return true;
+}
+
+// Soldiers a second the link of the base carries once settled: its own
+// growth and that of every base behind it.
+double
+SupplyGraph::GetFlow(const int Index) const
+{
+  return (double) Flow[Index] / SUPPLY_FLOW_SCALE;
+}
+
+// Soldiers a second the links into the base bring it once settled.
+double
+SupplyGraph::GetSupply(const int Index) const
+{
+  return (double) (Flow[Index] - Growth[Index]) / SUPPLY_FLOW_SCALE;
+}
+
+// Private Functions of SupplyGraph
+void
+SupplyGraph::AddFlow(int Index, const int64_t Delta)
+{
+  for(; Index >= 0; Index = Parent[Index]) { Flow[Index] += Delta; }
+}
+
+void
+SupplyGraph::ChangeFront(const int Index, const int NewFront)
+{
+  int Node = Index;
+
+  for(;;) {
+    Front[Node] = NewFront;
+    if(FirstChild[Node] >= 0) {
+      Node = FirstChild[Node];
+      continue;
+    }
+
+    while(Node != Index && NextSibling[Node] < 0) { Node = Parent[Node]; }
+    if(Node == Index) { return; }
+
+    Node = NextSibling[Node];
+  }
+}
+
+// Numbers the tree of Root depth first, without a stack.
+void
+SupplyGraph::Number(const int Root)
+{
+  int Node = Root;
+  int Label = 0;
+
+  for(;;) {
+    In[Node] = Label++;
+    if(FirstChild[Node] >= 0) {
+      Node = FirstChild[Node];
+      continue;
+    }
+
+    for(;;) {
+      Out[Node] = Label;
+      if(Node == Root) {
+        Dirty[Root] = 0;
+
+        return;
+      }
+
+      if(NextSibling[Node] >= 0) {
+        Node = NextSibling[Node];
+        break;
+      }
+
+      Node = Parent[Node];
+    }
+  }
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _SUPPLYGRAPH_HPP_
+#define _SUPPLYGRAPH_HPP_
+
+class SupplyGraph;
+
+#include <cstdint>
+
+// The links of the bases as a forest, each base pointing at the base it
+// sends its soldiers to.  A link only joins bases of one player, so every
+// tree is a supply route of one player, ending at its front: the root,
+// which keeps what reaches it.
+//
+// Every base knows its front, and every tree is numbered in depth first
+// order, so a link that would close a loop is found with one comparison.
+// The numbers are only redone when a tree has grown since they were made.
+//
+// The flow of a base is the growth of all the bases behind it, which is
+// what its link carries once the soldiers have settled.  The flows are
+// kept in fixed point so they do not depend on the order the links were
+// made in, e.g. after loading a saved game.
+class SupplyGraph {
+private:
+  int NumBases;
+
+  int *Parent;      // The linked base, -1 for none
+  int *FirstChild;  // The bases linked to this base, -1 for none
+  int *NextSibling;
+  int *PrevSibling;
+  int *Front;       // The root of the tree the base is in
+
+  // Depth first numbers, the bases behind a base numbered from In up to
+  // Out.  Only meaningful in trees that are not Dirty.
+  int *In;
+  int *Out;
+  uint8_t *Dirty;   // Of the roots
+
+  int64_t *Growth;  // Fixed point, see SUPPLY_FLOW_SCALE
+  int64_t *Flow;
+
+  void AddFlow(int Index, const int64_t Delta);
+  void ChangeFront(const int Index, const int NewFront);
+  void Number(const int Root);
+public:
+  SupplyGraph(void);
+  ~SupplyGraph(void);
+  bool CanLink(const int Index, const int TargetIndex);
+  void ChangeGrowth(const int Index, const double Value);
+  void ChangeLink(const int Index, const int TargetIndex);
+  bool Create(const int NumBases);
+  double GetFlow(const int Index) const;
+  int GetFront(const int Index) const { return Front[Index]; }
+  int GetNumBases(void) const { return NumBases; }
+  double GetSupply(const int Index) const;
+};
+
+#endif // _SUPPLYGRAPH_HPP_
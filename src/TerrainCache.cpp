@@ -0,0 +1,197 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TerrainCache.hpp"
+
+#include <algorithm>
+
+#include "Config.hpp"
+
+// The pixel size of a chunk.  Its tiles reach from (TERRAIN_CHUNK_SIZE - 1)
+// columns to the left of its first tile to as many to the right, and down
+// (TERRAIN_CHUNK_SIZE - 1) * 2 rows, each tile TILE_SIZE across.
+static const int ChunkWidth = TERRAIN_CHUNK_SIZE * TILE_SIZE;
+static const int ChunkHeight = (TERRAIN_CHUNK_SIZE + 1) * (TILE_SIZE / 2);
+
+TerrainCache::~TerrainCache(void)
+{
+  Clear();
+}
+
+// Drops every chunk.  Needed when the renderer loses what was drawn into
+// its target textures.
+void
+TerrainCache::Clear(void)
+{
+  for(size_t I = 0; I < Chunks.size(); I++) { SDL_DestroyTexture(Chunks[I].Texture); }
+
+  Chunks.clear();
+}
+
+void
+TerrainCache::Create(World *TerrainWorld)
+{
+  Clear();
+
+  this->TerrainWorld = TerrainWorld;
+  this->Frame = 0;
+}
+
+// Draws the chunks holding the tiles from MinX, MinY to MaxX, MaxY that
+// reach into the window.  Chunks are drawn row by row like the tiles in
+// them, so a tile still covers the ones behind it across chunk edges.
+void
+TerrainCache::Draw(VideoDriver *Video,
+                   const int Offset_X,
+                   const int Offset_Y,
+                   const int MinX,
+                   const int MinY,
+                   const int MaxX,
+                   const int MaxY, const bool Grid)
+{
+  int WindowWidth, WindowHeight;
+
+  Frame++;
+
+  if(MinX > MaxX || MinY > MaxY) { return; }
+
+  Video->GetWindowSize(WindowWidth, WindowHeight);
+
+  for(int ChunkY = MinY / TERRAIN_CHUNK_SIZE; ChunkY <= MaxY / TERRAIN_CHUNK_SIZE; ChunkY++) {
+    for(int ChunkX = MinX / TERRAIN_CHUNK_SIZE; ChunkX <= MaxX / TERRAIN_CHUNK_SIZE; ChunkX++) {
+      Chunk *TargetChunk;
+      int PixelX, PixelY;
+
+      GetChunkPixelLoc(ChunkX, ChunkY, PixelX, PixelY);
+      PixelX += Offset_X;
+      PixelY += Offset_Y;
+
+      if(PixelX >= WindowWidth  || PixelX + ChunkWidth <= 0)  { continue; }
+      if(PixelY >= WindowHeight || PixelY + ChunkHeight <= 0) { continue; }
+
+      TargetChunk = FindChunk(Video, ChunkX, ChunkY, Grid);
+      if(TargetChunk == nullptr) {
+        DrawTiles(Video, ChunkX, ChunkY, Offset_X, Offset_Y, Grid);
+        continue;
+      }
+
+      Video->DrawTexture(TargetChunk->Texture,
+                         ChunkWidth, ChunkHeight,
+                         0, 0, ChunkWidth, ChunkHeight, PixelX, PixelY);
+    }
+  }
+}
+
+// Private Functions of TerrainCache
+void
+TerrainCache::BuildChunk(VideoDriver *Video, Chunk &TargetChunk)
+{
+  int PixelX, PixelY;
+
+  GetChunkPixelLoc(TargetChunk.ChunkX, TargetChunk.ChunkY, PixelX, PixelY);
+
+  Video->ChangeRenderTarget(TargetChunk.Texture);
+  Video->ClearTransparent();
+  DrawTiles(Video, TargetChunk.ChunkX, TargetChunk.ChunkY, -PixelX, -PixelY, TargetChunk.Grid);
+  Video->ChangeRenderTarget(nullptr);
+}
+
+void
+TerrainCache::DrawTiles(VideoDriver *Video,
+                        const int ChunkX,
+                        const int ChunkY,
+                        const int Offset_X,
+                        const int Offset_Y, const bool Grid)
+{
+  int SizeX, SizeY;
+  int EndX, EndY;
+
+  TerrainWorld->GetSize(SizeX, SizeY);
+
+  EndX = std::min((ChunkX + 1) * TERRAIN_CHUNK_SIZE, SizeX);
+  EndY = std::min((ChunkY + 1) * TERRAIN_CHUNK_SIZE, SizeY);
+
+  for(int Y = ChunkY * TERRAIN_CHUNK_SIZE; Y < EndY; Y++) {
+    for(int X = ChunkX * TERRAIN_CHUNK_SIZE; X < EndX; X++) {
+      Video->DrawTile(X, Y, Offset_X, Offset_Y, TerrainWorld->GetTileType(X, Y));
+      if(Grid) {
+        Video->DrawTile(X, Y, Offset_X, Offset_Y, TileType::BlackHighlight);
+      }
+    }
+  }
+}
+
+// Returns the chunk, drawing it first if it is not cached.  Once the cache
+// is full the texture of the chunk drawn least recently is used for it.
+// Returns nullptr if no texture could be made for it.
+TerrainCache::Chunk *
+TerrainCache::FindChunk(VideoDriver *Video,
+                        const int ChunkX,
+                        const int ChunkY, const bool Grid)
+{
+  Chunk *TargetChunk = nullptr;
+
+  for(size_t I = 0; I < Chunks.size(); I++) {
+    Chunk &Cached = Chunks[I];
+
+    if(Cached.ChunkX == ChunkX && Cached.ChunkY == ChunkY && Cached.Grid == Grid) {
+      Cached.LastUsed = Frame;
+
+      return &Cached;
+    }
+
+    if(TargetChunk == nullptr || Cached.LastUsed < TargetChunk->LastUsed) {
+      TargetChunk = &Cached;
+    }
+  }
+
+  if(Chunks.size() < TERRAIN_CACHE_SIZE) {
+    Chunk NewChunk;
+
+    NewChunk.Texture = Video->CreateTargetTexture(ChunkWidth, ChunkHeight);
+    if(NewChunk.Texture == nullptr) { return nullptr; }
+
+    Chunks.push_back(NewChunk);
+    TargetChunk = &Chunks.back();
+  }
+
+  TargetChunk->ChunkX = ChunkX;
+  TargetChunk->ChunkY = ChunkY;
+  TargetChunk->Grid = Grid;
+  TargetChunk->LastUsed = Frame;
+
+  BuildChunk(Video, *TargetChunk);
+
+  return TargetChunk;
+}
+
+// The pixel location of a chunk's texture, left of its first tile by
+// (TERRAIN_CHUNK_SIZE - 1) columns.  See VideoDriver::DrawTile().
+void
+TerrainCache::GetChunkPixelLoc(const int ChunkX,
+                               const int ChunkY,
+                               int &PixelX, int &PixelY)
+{
+  const int X = ChunkX * TERRAIN_CHUNK_SIZE;
+  const int Y = ChunkY * TERRAIN_CHUNK_SIZE;
+
+  PixelX = (-X + Y - (TERRAIN_CHUNK_SIZE - 1)) * (TILE_SIZE / 2);
+  PixelY = (X + Y) * (TILE_SIZE / 4);
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _TERRAINCACHE_HPP_
+#define _TERRAINCACHE_HPP_
+
+class TerrainCache;
+
+#include <vector>
+#include <SDL2/SDL_render.h>
+
+#include "Video.hpp"
+#include "World.hpp"
+
+// The terrain does not change once the world is made, so it is drawn into
+// textures of TERRAIN_CHUNK_SIZE by TERRAIN_CHUNK_SIZE tiles and those are
+// copied to the screen instead.  A chunk is drawn when it first comes into
+// view, with or without the grid, and the chunks drawn least recently are
+// dropped once there are TERRAIN_CACHE_SIZE of them.  If the renderer can
+// not draw to textures the tiles are drawn one by one as before.
+class TerrainCache {
+private:
+  struct Chunk {
+    SDL_Texture *Texture;
+    int ChunkX, ChunkY;
+    bool Grid;
+    unsigned long LastUsed;
+  };
+
+  std::vector<Chunk> Chunks;
+  World *TerrainWorld;
+  unsigned long Frame;
+
+  void BuildChunk(VideoDriver *Video, Chunk &TargetChunk);
+  void DrawTiles(VideoDriver *Video,
+                 const int ChunkX,
+                 const int ChunkY,
+                 const int Offset_X,
+                 const int Offset_Y, const bool Grid);
+  Chunk *FindChunk(VideoDriver *Video,
+                   const int ChunkX,
+                   const int ChunkY, const bool Grid);
+  static void GetChunkPixelLoc(const int ChunkX,
+                               const int ChunkY,
+                               int &PixelX, int &PixelY);
+public:
+  ~TerrainCache(void);
+  TerrainCache(void) { }
+  void Clear(void);
+  void Create(World *TerrainWorld);
+  void Draw(VideoDriver *Video,
+            const int Offset_X,
+            const int Offset_Y,
+            const int MinX,
+            const int MinY,
+            const int MaxX,
+            const int MaxY, const bool Grid);
+};
+
+#endif // _TERRAINCACHE_HPP_
@@ -0,0 +1,164 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ThreadPool.hpp"
+
+// The pool and queue the calling thread works for, if any.
+static thread_local ThreadPool *WorkerPool = nullptr;
+static thread_local int WorkerIndex = -1;
+
+ThreadPool::~ThreadPool(void)
+{
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+
+    Stopping = true;
+  }
+
+  WorkAvailable.notify_all();
+  for(int I = 0; I < NumThreads; I++) { Threads[I].join(); }
+
+  delete[] Threads;
+  delete[] Queues;
+}
+
+bool
+ThreadPool::Create(const int NumThreads)
+{
+  this->NumThreads = NumThreads;
+  if(this->NumThreads <= 0) {
+    this->NumThreads = (int) std::thread::hardware_concurrency();
+    if(this->NumThreads <= 0) { this->NumThreads = 1; }
+  }
+
+  this->NumQueued = 0;
+  this->NumPending = 0;
+  this->NextQueue = 0;
+  this->Stopping = false;
+
+  Queues = new WorkQueue[this->NumThreads];
+  Threads = new std::thread[this->NumThreads];
+  if(Queues == nullptr || Threads == nullptr) { return false; }
+
+  for(int I = 0; I < this->NumThreads; I++) {
+    Threads[I] = std::thread(&ThreadPool::WorkerLoop, this, I);
+  }
+
+  return true;
+}
+
+void
+ThreadPool::Submit(std::function<void(void)> Task)
+{
+  int Index;
+
+  // Count the task before it can be taken, so Wait() never sees the
+  // finished task before the submitted one.
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+
+    NumQueued++;
+    NumPending++;
+
+    // Tasks queued by a worker go to its own queue, the rest are dealt out.
+    if(WorkerPool == this) {
+      Index = WorkerIndex;
+    } else {
+      Index = NextQueue++ % NumThreads;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> Guard(Queues[Index].Lock);
+
+    Queues[Index].Tasks.push_back(std::move(Task));
+  }
+
+  WorkAvailable.notify_one();
+}
+
+void
+ThreadPool::Wait(void)
+{
+  std::unique_lock<std::mutex> Guard(Lock);
+
+  WorkDone.wait(Guard, [this] { return NumPending == 0; });
+}
+
+// Private Functions of ThreadPool
+bool
+ThreadPool::PopTask(const int Index, std::function<void(void)> &Task)
+{
+  {
+    std::lock_guard<std::mutex> Guard(Queues[Index].Lock);
+
+    if(!Queues[Index].Tasks.empty()) {
+      Task = std::move(Queues[Index].Tasks.back());
+      Queues[Index].Tasks.pop_back();
+
+      return true;
+    }
+  }
+
+  for(int I = 1; I < NumThreads; I++) {
+    WorkQueue &Victim = Queues[(Index + I) % NumThreads];
+    std::lock_guard<std::mutex> Guard(Victim.Lock);
+
+    if(!Victim.Tasks.empty()) {
+      Task = std::move(Victim.Tasks.front());
+      Victim.Tasks.pop_front();
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+ThreadPool::WorkerLoop(const int Index)
+{
+  WorkerPool = this;
+  WorkerIndex = Index;
+
+  for(;;) {
+    std::function<void(void)> Task;
+
+    if(PopTask(Index, Task)) {
+      {
+        std::lock_guard<std::mutex> Guard(Lock);
+
+        NumQueued--;
+      }
+
+      Task();
+
+      std::lock_guard<std::mutex> Guard(Lock);
+
+      if(--NumPending == 0) { WorkDone.notify_all(); }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> Guard(Lock);
+
+    WorkAvailable.wait(Guard, [this] { return Stopping || NumQueued > 0; });
+    if(Stopping && NumQueued == 0) { return; }
+  }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2020 Ebenvulpo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _THREADPOOL_HPP_
+#define _THREADPOOL_HPP_
+
+class ThreadPool;
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// A fixed set of worker threads, each with its own queue of tasks.  A
+// worker runs its newest task first and, once its queue is empty, steals
+// the oldest task of another worker.  Wait() blocks until every task
+// submitted so far has run and must not be called from a task.
+class ThreadPool {
+private:
+  struct WorkQueue {
+    std::mutex Lock;
+    std::deque<std::function<void(void)>> Tasks;
+  };
+
+  int NumThreads;
+  WorkQueue *Queues;
+  std::thread *Threads;
+
+  std::mutex Lock;
+  std::condition_variable WorkAvailable;
+  std::condition_variable WorkDone;
+  int NumQueued;
+  int NumPending;
+  unsigned int NextQueue;
+  bool Stopping;
+
+  bool PopTask(const int Index, std::function<void(void)> &Task);
+  void WorkerLoop(const int Index);
+public:
+  ThreadPool(void) { }
+  ~ThreadPool(void);
+  bool Create(const int NumThreads);
+  int GetNumThreads(void) const { return NumThreads; }
+  void Submit(std::function<void(void)> Task);
+  void Wait(void);
+};
+
+#endif // _THREADPOOL_HPP_
@@ -21,9 +21,9 @@
 #ifndef _TILE_HPP_
 #define _TILE_HPP_
 
-class Tile;
+#include <cstdint>
 
-enum class TileType {
+enum class TileType : uint8_t {
   Base,
   Forest,
   Grassland,
@@ -40,24 +40,42 @@ enum class TileType {
   Water,
 };
 
-class Tile {
-private:
-  TileType Type;
-  int LocX, LocY;
-
-public:
-  ~Tile(void) { }
-  Tile(void) { }
-  void ChangeType(const TileType Type) { this->Type = Type; }
-  void Create(const TileType Type,
-              const int LocX, const int LocY) { this->Type = Type; this->LocX = LocX; this->LocY = LocY; }
-  int GetDefenseValue(void) const;
-  double GetDistanceToTile(const Tile *TargetTile) const;
-  int GetHeightValue(void) const;
-  TileType GetType(void) const { return this->Type; }
-  void GetLoc(int &X, int &Y) const { X = LocX; Y = LocY; }
+#define NUM_TILE_TYPES 14
+static_assert((int) TileType::Water + 1 == NUM_TILE_TYPES, "NUM_TILE_TYPES is out of date");
+
+// Attributes of every tile type, in TileType order.  Only land is ever
+// stored in the world; the rest count as flat water with no defence.
+// The tiles are in the same order in the video atlas, so a TileType is
+// also its texture index.
+static constexpr int TileDefenseValues[NUM_TILE_TYPES] = {
+  0,  // Base
+  4,  // Forest
+  0,  // Grassland
+  6,  // Hill
+  10, // Mountain
+  0, 0, 0, 0, 0, 0, 0, 0, // Highlights
+  0,  // Water
+};
+
+static constexpr int TileHeightValues[NUM_TILE_TYPES] = {
+  0, // Base
+  1, // Forest
+  1, // Grassland
+  2, // Hill
+  3, // Mountain
+  0, 0, 0, 0, 0, 0, 0, 0, // Highlights
+  0, // Water
 };
 
-TileType GetTileTypeFromHeight(const int Height);
+constexpr int GetTileDefenseValue(const TileType Type) { return TileDefenseValues[(int) Type]; }
+constexpr int GetTileHeightValue(const TileType Type) { return TileHeightValues[(int) Type]; }
+
+constexpr TileType
+GetTileTypeFromHeight(const int Height)
+{
+  return (Height == 0) ? TileType::Water :
+         (Height == 1) ? TileType::Grassland :
+         (Height == 2) ? TileType::Hill : TileType::Mountain;
+}
 
 #endif /* _TILE_HPP_ */
@@ -58,14 +58,14 @@ void VictoryWindow(Game *MainGame, VideoDriver *Video)
   VictoryWin->Center(WindowWidth, WindowHeight);
 
   LongestName = 0;
-  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) {
+  for(int I = 0; I < MainGame->GetNumPlayers(); I++) {
     size_t NameLength;
 
     NameLength = strlen(PlayerNames[I]);
     if(NameLength > LongestName) { LongestName = NameLength; }
   }
 
-  for(int I = 0; I < NUMBER_OF_PLAYERS; I++) {
+  for(int I = 0; I < MainGame->GetNumPlayers(); I++) {
     const Player *TargetPlayer = MainGame->GetPlayer(I);
     Label *NewLabel;
     char Buffer2[256];
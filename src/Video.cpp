@@ -20,29 +20,57 @@
 
 #include "Video.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_surface.h>
+#include <SDL2/SDL_version.h>
 
 #include "Application.hpp"
 #include "Config.hpp"
+#include "Profiler.hpp"
 
 extern BcApplication *Application;
 
+// The images packed into the atlas: the tiles in TileType order, then the
+// cursor and the font.
+static const char *AtlasNames[] = {
+  "Base.png",
+  "Forest.png",
+  "Grassland.png",
+  "Hill.png",
+  "Mountain.png",
+  "BlackHighlight.png",
+  "BrownHighlight.png",
+  "CyanHighlight.png",
+  "GrayHighlight.png",
+  "RedHighlight.png",
+  "PurpleHighlight.png",
+  "YellowHighlight.png",
+  "WhiteHighlight.png",
+  "Water.png",
+  "Cursor.png",
+  "Fontset.png"
+};
+
+#define NUM_ATLAS_IMAGES ((int) (sizeof(AtlasNames) / sizeof(AtlasNames[0])))
+#define ATLAS_MAX_WIDTH 512 // Widest row of images in the atlas
+#define ATLAS_PADDING 2     // Empty pixels around each image
+#define WHITE_SIZE 4        // Sides of the white patch, sampled at its middle
+
 static SDL_Surface *LoadSurfaceFromPath(const char *Application, const char *SurfaceName);
 static SDL_Texture *LoadTextureFromPath(SDL_Renderer *Renderer,
                                         const char *ApplicationPath, const char *TextureName);
+static void PackAtlas(const int NumRects, SDL_Rect *Rects, int &Width, int &Height);
 
 VideoDriver::~VideoDriver(void)
 {
-  for(int I = 0; I < NUM_TEXTURES; I++) { SDL_DestroyTexture(Textures[I]); }
-
   IMG_Quit();
 
-  SDL_DestroyTexture(Cursor);
-  SDL_DestroyTexture(Fonts);
+  SDL_DestroyTexture(Atlas);
   SDL_DestroyRenderer(MainRenderer);
   SDL_DestroyWindow(MainWindow);
 }
@@ -63,13 +91,63 @@ VideoDriver::ChangeFullscreenMode(const bool Fullscreen)
   return true;
 }
 
+// Draws to Target instead of the window until it is changed back with
+// nullptr.
+void
+VideoDriver::ChangeRenderTarget(SDL_Texture *Target)
+{
+  Flush();
+  SDL_SetRenderTarget(MainRenderer, Target);
+}
+
 void
 VideoDriver::Clear(void)
 {
+  Flush();
   SDL_SetRenderDrawColor(MainRenderer, 0x00, 0x00, 0x00, 0xFF);
   SDL_RenderClear(MainRenderer);
 }
 
+void
+VideoDriver::ClearTransparent(void)
+{
+  Flush();
+  SDL_SetRenderDrawColor(MainRenderer, 0x00, 0x00, 0x00, 0x00);
+  SDL_RenderClear(MainRenderer);
+}
+
+// Makes a texture that can be drawn into with ChangeRenderTarget().
+// Returns nullptr if the renderer can not draw to textures.
+//
+// Drawing blended textures into a clear target leaves its colours already
+// multiplied by their alpha, so where SDL allows it the target is copied
+// back out without multiplying them again.
+SDL_Texture *
+VideoDriver::CreateTargetTexture(const int Width, const int Height)
+{
+  SDL_Texture *Texture;
+
+  if(!SDL_RenderTargetSupported(MainRenderer)) { return nullptr; }
+
+  Texture = SDL_CreateTexture(MainRenderer, SDL_PIXELFORMAT_RGBA8888,
+                              SDL_TEXTUREACCESS_TARGET, Width, Height);
+  if(Texture == nullptr) { return nullptr; }
+
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+  SDL_SetTextureBlendMode(Texture,
+                          SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE,
+                                                     SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                                     SDL_BLENDOPERATION_ADD,
+                                                     SDL_BLENDFACTOR_ONE,
+                                                     SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                                     SDL_BLENDOPERATION_ADD));
+#else
+  SDL_SetTextureBlendMode(Texture, SDL_BLENDMODE_BLEND);
+#endif // SDL_VERSION_ATLEAST(2, 0, 6)
+
+  return Texture;
+}
+
 void
 VideoDriver::DrawBox(const int Width,
                      const int Height,
@@ -79,15 +157,30 @@ VideoDriver::DrawBox(const int Width,
                      const Uint8 Green,
                      const Uint8 Blue, const Uint8 Alpha)
 {
+  const SDL_Color Color = { Red, Green, Blue, Alpha };
   SDL_Rect Rect;
 
+  if(Width <= 0 || Height <= 0) { return; }
+
+  // Top and bottom, then the sides between them.
   Rect.x = X;
   Rect.y = Y;
   Rect.w = Width;
-  Rect.h = Height;
+  Rect.h = 1;
+  QueueRect(Rect, Color);
+
+  Rect.y = Y + Height - 1;
+  QueueRect(Rect, Color);
 
-  SDL_SetRenderDrawColor(MainRenderer, Red, Green, Blue, Alpha);
-  SDL_RenderDrawRect(MainRenderer, &Rect);
+  if(Height <= 2) { return; }
+
+  Rect.y = Y + 1;
+  Rect.w = 1;
+  Rect.h = Height - 2;
+  QueueRect(Rect, Color);
+
+  Rect.x = X + Width - 1;
+  QueueRect(Rect, Color);
 }
 
 void
@@ -97,10 +190,10 @@ VideoDriver::DrawCursor(const int X, const int Y)
 
   Dest.x = X;
   Dest.y = Y;
-  Dest.w = 16;
-  Dest.h = 16;
+  Dest.w = CursorRect.w;
+  Dest.h = CursorRect.h;
 
-  SDL_RenderCopy(MainRenderer, Cursor, nullptr, &Dest);
+  QueueSprite(Atlas, CursorRect, Dest);
 }
 
 void
@@ -112,8 +205,9 @@ VideoDriver::DrawLine(const int StartX,
                       const Uint8 Green,
                       const Uint8 Blue, const Uint8 Alpha)
 {
-  SDL_SetRenderDrawColor(MainRenderer, Red, Green, Blue, Alpha);
-  SDL_RenderDrawLine(MainRenderer, StartX, StartY, EndX, EndY);
+  const SDL_Color Color = { Red, Green, Blue, Alpha };
+
+  QueueLine(StartX, StartY, EndX, EndY, Color);
 }
 
 void
@@ -125,6 +219,7 @@ VideoDriver::DrawRect(const int Width,
                       const Uint8 Green,
                       const Uint8 Blue, const Uint8 Alpha)
 {
+  const SDL_Color Color = { Red, Green, Blue, Alpha };
   SDL_Rect Rect;
 
   Rect.x = X;
@@ -132,16 +227,41 @@ VideoDriver::DrawRect(const int Width,
   Rect.w = Width;
   Rect.h = Height;
 
-  SDL_SetRenderDrawColor(MainRenderer, Red, Green, Blue, Alpha);
-  SDL_RenderFillRect(MainRenderer, &Rect);
+  QueueRect(Rect, Color);
 }
 
 void
 VideoDriver::DrawStr(const char *String, const int X, const int Y, const double Scale)
 {
+#if VIDEO_BATCHING
+  int First;
+
+  ChangeBatchTexture(Atlas);
+
+  const TextRun &Run = GetTextRun(String, Scale);
+
+  First = (int) BatchVertices.size();
+  for(size_t I = 0; I < Run.Vertices.size(); I++) {
+    SDL_Vertex Vertex = Run.Vertices[I];
+
+    Vertex.position.x += X;
+    Vertex.position.y += Y;
+    BatchVertices.push_back(Vertex);
+  }
+
+  for(int Quad = First; Quad < (int) BatchVertices.size(); Quad += 4) {
+    BatchIndices.push_back(Quad);
+    BatchIndices.push_back(Quad + 1);
+    BatchIndices.push_back(Quad + 2);
+    BatchIndices.push_back(Quad);
+    BatchIndices.push_back(Quad + 2);
+    BatchIndices.push_back(Quad + 3);
+  }
+#else
   for(int I = 0; String[I] != '\0'; I++) {
     DrawChar(String[I], X + (I * (int) (FONT_WIDTH * Scale)), Y, Scale);
   }
+#endif // VIDEO_BATCHING
 }
 
 void
@@ -167,7 +287,7 @@ VideoDriver::DrawTexture(SDL_Texture *Texture,
   Dest.w = Width;
   Dest.h = Height;
 
-  SDL_RenderCopy(MainRenderer, Texture, &Src, &Dest);
+  QueueSprite(Texture, Src, Dest);
 }
 
 void
@@ -176,26 +296,38 @@ VideoDriver::DrawTile(const int X,
                       const int Offset_X,
                       const int Offset_Y, const TileType Type)
 {
-  SDL_Rect Src;
   SDL_Rect Dest;
 
-  Src.x = 0;
-  Src.y = 0;
-  Src.w = TILE_SIZE;
-  Src.h = TILE_SIZE;
-
   Dest.x = (-X + Y) * (TILE_SIZE / 2) + Offset_X;
   Dest.y = (X + Y) * (TILE_SIZE / 4) + Offset_Y;
   Dest.w = TILE_SIZE;
   Dest.h = TILE_SIZE;
 
-  SDL_RenderCopy(MainRenderer, Textures[(int) Type], &Src, &Dest);
+  QueueSprite(Atlas, TileRects[(int) Type], Dest);
 }
 
 void
 VideoDriver::Finish(void)
 {
+  PROFILE_ZONE(Present);
+
+  Flush();
   SDL_RenderPresent(this->MainRenderer);
+
+#if VIDEO_BATCHING
+  // Once there is too much text kept, drop what was not drawn this frame.
+  if(TextRuns.size() > TEXT_CACHE_SIZE) {
+    for(auto It = TextRuns.begin(); It != TextRuns.end();) {
+      if(It->second.LastUsed != Frame) {
+        It = TextRuns.erase(It);
+      } else {
+        ++It;
+      }
+    }
+  }
+
+  Frame++;
+#endif // VIDEO_BATCHING
 }
 
 void
@@ -212,6 +344,10 @@ VideoDriver::Init(const char *ApplicationPath)
 
   WindowWidth = WINDOW_WIDTH;
   WindowHeight = WINDOW_HEIGHT;
+  BatchTexture = nullptr;
+#if VIDEO_BATCHING
+  Frame = 0;
+#endif // VIDEO_BATCHING
 
   MainWindow =
     SDL_CreateWindow("Base Conqueror",
@@ -262,28 +398,7 @@ VideoDriver::Init(const char *ApplicationPath)
     return false;
   }
 
-  if(!LoadCursor(ApplicationPath)) {
-    SDL_DestroyRenderer(MainRenderer);
-    SDL_DestroyWindow(MainWindow);
-
-    std::cerr << "Error: Could not load cursor." << std::endl;
-
-    return false;
-  }
-
-  if(!LoadFonts(ApplicationPath)) {
-    SDL_DestroyTexture(Cursor);
-    SDL_DestroyRenderer(MainRenderer);
-    SDL_DestroyWindow(MainWindow);
-
-    std::cerr << "Error: Could not load fontset." << std::endl;
-
-    return false;
-  }
-
-  if(!LoadTextures(ApplicationPath)) {
-    SDL_DestroyTexture(Cursor);
-    SDL_DestroyTexture(Fonts);
+  if(!LoadAtlas(ApplicationPath)) {
     SDL_DestroyRenderer(MainRenderer);
     SDL_DestroyWindow(MainWindow);
 
@@ -300,43 +415,58 @@ VideoDriver::Init(const char *ApplicationPath)
   return true;
 }
 
-bool
-VideoDriver::LoadTextures(const char *ApplicationPath)
+// Private Functions of VideoDriver
+#if VIDEO_BATCHING
+// Adds a quad, its corners given clockwise from the top left along with
+// the pixels of Texture they show.
+void
+VideoDriver::AddQuad(SDL_Texture *Texture,
+                     const SDL_FPoint *Points,
+                     const SDL_FPoint *TexturePoints, const SDL_Color &Color)
 {
-  static const char *TileNames[] = {
-    "Base.png",
-    "Forest.png",
-    "Grassland.png",
-    "Hill.png",
-    "Mountain.png",
-    "BlackHighlight.png",
-    "BrownHighlight.png",
-    "CyanHighlight.png",
-    "GrayHighlight.png",
-    "RedHighlight.png",
-    "PurpleHighlight.png",
-    "YellowHighlight.png",
-    "WhiteHighlight.png",
-    "Water.png"
-  };
-
-  for(int I = 0; I < NUM_TEXTURES; I++) {
-    Textures[I] = LoadTextureFromPath(MainRenderer, ApplicationPath, TileNames[I]);
-    if(Textures[I] == nullptr) { abort(); }
+  int First;
+
+  ChangeBatchTexture(Texture);
+  First = (int) BatchVertices.size();
+
+  for(int I = 0; I < 4; I++) {
+    SDL_Vertex Vertex;
+
+    Vertex.position = Points[I];
+    Vertex.color = Color;
+    Vertex.tex_coord.x = TexturePoints[I].x / BatchTextureWidth;
+    Vertex.tex_coord.y = TexturePoints[I].y / BatchTextureHeight;
+    BatchVertices.push_back(Vertex);
   }
 
-  return true;
+  BatchIndices.push_back(First);
+  BatchIndices.push_back(First + 1);
+  BatchIndices.push_back(First + 2);
+  BatchIndices.push_back(First);
+  BatchIndices.push_back(First + 2);
+  BatchIndices.push_back(First + 3);
 }
 
-// Private Functions of VideoDriver
+void
+VideoDriver::ChangeBatchTexture(SDL_Texture *Texture)
+{
+  if(Texture == BatchTexture) { return; }
+
+  Flush();
+
+  BatchTexture = Texture;
+  SDL_QueryTexture(Texture, nullptr, nullptr, &BatchTextureWidth, &BatchTextureHeight);
+}
+#endif // VIDEO_BATCHING
+
 void
 VideoDriver::DrawChar(const char Ch, const int X, const int Y, const double Scale)
 {
   SDL_Rect FontSrc;
   SDL_Rect FontDst;
 
-  FontSrc.x = (Ch % 16) * FONT_WIDTH;
-  FontSrc.y = (Ch / 16) * FONT_HEIGHT;
+  FontSrc.x = FontsRect.x + (Ch % 16) * FONT_WIDTH;
+  FontSrc.y = FontsRect.y + (Ch / 16) * FONT_HEIGHT;
   FontSrc.w = FONT_WIDTH;
   FontSrc.h = FONT_HEIGHT;
 
@@ -345,25 +475,130 @@ VideoDriver::DrawChar(const char Ch, const int X, const int Y, const double Scal
   FontDst.w = FONT_WIDTH * Scale;
   FontDst.h = FONT_HEIGHT * Scale;
 
-  SDL_RenderCopy(MainRenderer, Fonts, &FontSrc, &FontDst);
+  QueueSprite(Atlas, FontSrc, FontDst);
 }
 
-bool
-VideoDriver::LoadCursor(const char *ApplicationPath)
+// Sends the batch to SDL.
+void
+VideoDriver::Flush(void)
 {
-  this->Cursor = LoadTextureFromPath(MainRenderer, ApplicationPath, "Cursor.png");
-  if(this->Cursor == nullptr) { return false; }
+#if VIDEO_BATCHING
+  if(!BatchIndices.empty()) {
+    SDL_RenderGeometry(MainRenderer, BatchTexture,
+                       BatchVertices.data(), (int) BatchVertices.size(),
+                       BatchIndices.data(), (int) BatchIndices.size());
+    BatchVertices.clear();
+    BatchIndices.clear();
+  }
+#endif // VIDEO_BATCHING
 
-  return true;
+  // The texture may be freed once it has been drawn.
+  BatchTexture = nullptr;
+}
+
+#if VIDEO_BATCHING
+// Lays out the string with DrawChar()'s spacing the first time it is drawn
+// at this scale.  The atlas must be the batch texture.
+const VideoDriver::TextRun &
+VideoDriver::GetTextRun(const char *String, const double Scale)
+{
+  const int Advance = (int) (FONT_WIDTH * Scale);
+  const int GlyphWidth = (int) (FONT_WIDTH * Scale);
+  const int GlyphHeight = (int) (FONT_HEIGHT * Scale);
+  std::unordered_map<std::string, TextRun>::iterator Found;
+
+  // The key reuses one buffer, so looking up a string does not allocate.
+  TextKey.assign(String);
+  TextKey.append((const char *) &Scale, sizeof(Scale));
+
+  Found = TextRuns.find(TextKey);
+  if(Found != TextRuns.end()) {
+    Found->second.LastUsed = Frame;
+
+    return Found->second;
+  }
+
+  TextRun &Run = TextRuns[TextKey];
+
+  Run.LastUsed = Frame;
+  for(int I = 0; String[I] != '\0'; I++) {
+    const SDL_Color White = { 0xFF, 0xFF, 0xFF, 0xFF };
+    const float SourceX = FontsRect.x + (String[I] % 16) * FONT_WIDTH;
+    const float SourceY = FontsRect.y + (String[I] / 16) * FONT_HEIGHT;
+    const float X = I * Advance;
+    SDL_Vertex Vertex;
+
+    Vertex.color = White;
+
+    for(int Corner = 0; Corner < 4; Corner++) {
+      const bool Right = (Corner == 1 || Corner == 2);
+      const bool Bottom = (Corner >= 2);
+
+      Vertex.position.x = X + (Right ? GlyphWidth : 0);
+      Vertex.position.y = Bottom ? GlyphHeight : 0;
+      Vertex.tex_coord.x = (SourceX + (Right ? FONT_WIDTH : 0)) / BatchTextureWidth;
+      Vertex.tex_coord.y = (SourceY + (Bottom ? FONT_HEIGHT : 0)) / BatchTextureHeight;
+      Run.Vertices.push_back(Vertex);
+    }
+  }
+
+  return Run;
 }
+#endif // VIDEO_BATCHING
 
 bool
-VideoDriver::LoadFonts(const char *ApplicationPath)
+VideoDriver::LoadAtlas(const char *ApplicationPath)
 {
-  Fonts = LoadTextureFromPath(MainRenderer, ApplicationPath, "Fontset.png");
-  if(Fonts == nullptr) { return false; }
+  SDL_Surface *Surfaces[NUM_ATLAS_IMAGES] = { };
+  SDL_Rect Rects[NUM_ATLAS_IMAGES + 1];
+  SDL_Surface *AtlasSurface = nullptr;
+  int Width, Height;
+
+  for(int I = 0; I < NUM_ATLAS_IMAGES; I++) {
+    Surfaces[I] = LoadSurfaceFromPath(ApplicationPath, AtlasNames[I]);
+    if(Surfaces[I] == nullptr) { goto Error; }
+
+    Rects[I].w = Surfaces[I]->w;
+    Rects[I].h = Surfaces[I]->h;
+  }
+
+  Rects[NUM_ATLAS_IMAGES].w = WHITE_SIZE;
+  Rects[NUM_ATLAS_IMAGES].h = WHITE_SIZE;
+
+  PackAtlas(NUM_ATLAS_IMAGES + 1, Rects, Width, Height);
+
+  AtlasSurface = SDL_CreateRGBSurfaceWithFormat(0, Width, Height, 32, SDL_PIXELFORMAT_RGBA32);
+  if(AtlasSurface == nullptr) { goto Error; }
+
+  // Copy the pixels as they are.  The colour key still leaves the
+  // background of each image clear.
+  for(int I = 0; I < NUM_ATLAS_IMAGES; I++) {
+    SDL_SetSurfaceBlendMode(Surfaces[I], SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(Surfaces[I], nullptr, AtlasSurface, &Rects[I]);
+  }
+
+  SDL_FillRect(AtlasSurface, &Rects[NUM_ATLAS_IMAGES],
+               SDL_MapRGBA(AtlasSurface->format, 0xFF, 0xFF, 0xFF, 0xFF));
+
+  Atlas = SDL_CreateTextureFromSurface(MainRenderer, AtlasSurface);
+  if(Atlas == nullptr) { goto Error; }
+
+  SDL_SetTextureBlendMode(Atlas, SDL_BLENDMODE_BLEND);
+
+  for(int I = 0; I < NUM_TEXTURES; I++) { TileRects[I] = Rects[I]; }
+  CursorRect = Rects[NUM_TEXTURES];
+  FontsRect = Rects[NUM_TEXTURES + 1];
+  WhiteRect = Rects[NUM_ATLAS_IMAGES];
+
+  SDL_FreeSurface(AtlasSurface);
+  for(int I = 0; I < NUM_ATLAS_IMAGES; I++) { SDL_FreeSurface(Surfaces[I]); }
 
   return true;
+Error:
+  SDL_FreeSurface(AtlasSurface);
+  for(int I = 0; I < NUM_ATLAS_IMAGES; I++) { SDL_FreeSurface(Surfaces[I]); }
+
+  return false;
 }
 
 bool
@@ -391,6 +626,117 @@ VideoDriver::LoadTexture(const char *Filename)
   return Texture;
 }
 
+// Lines are quads one pixel wide, reaching half a pixel past each end so
+// they cover the same pixels as SDL_RenderDrawLine().
+void
+VideoDriver::QueueLine(const int StartX,
+                       const int StartY,
+                       const int EndX,
+                       const int EndY, const SDL_Color &Color)
+{
+#if VIDEO_BATCHING
+  const float DeltaX = (float) (EndX - StartX);
+  const float DeltaY = (float) (EndY - StartY);
+  const float Length = std::sqrt(DeltaX * DeltaX + DeltaY * DeltaY);
+  SDL_FPoint Points[4];
+  SDL_FPoint TexturePoints[4];
+  float AlongX, AlongY;
+  float AcrossX, AcrossY;
+
+  if(Length == 0.0f) {
+    SDL_Rect Rect = { StartX, StartY, 1, 1 };
+
+    QueueRect(Rect, Color);
+    return;
+  }
+
+  AlongX = DeltaX / Length * 0.5f;
+  AlongY = DeltaY / Length * 0.5f;
+  AcrossX = -AlongY;
+  AcrossY = AlongX;
+
+  Points[0].x = StartX + 0.5f - AlongX + AcrossX;
+  Points[0].y = StartY + 0.5f - AlongY + AcrossY;
+  Points[1].x = EndX + 0.5f + AlongX + AcrossX;
+  Points[1].y = EndY + 0.5f + AlongY + AcrossY;
+  Points[2].x = EndX + 0.5f + AlongX - AcrossX;
+  Points[2].y = EndY + 0.5f + AlongY - AcrossY;
+  Points[3].x = StartX + 0.5f - AlongX - AcrossX;
+  Points[3].y = StartY + 0.5f - AlongY - AcrossY;
+
+  for(int I = 0; I < 4; I++) {
+    TexturePoints[I].x = WhiteRect.x + WHITE_SIZE / 2.0f;
+    TexturePoints[I].y = WhiteRect.y + WHITE_SIZE / 2.0f;
+  }
+
+  AddQuad(Atlas, Points, TexturePoints, Color);
+#else
+  SDL_SetRenderDrawColor(MainRenderer, Color.r, Color.g, Color.b, Color.a);
+  SDL_RenderDrawLine(MainRenderer, StartX, StartY, EndX, EndY);
+#endif // VIDEO_BATCHING
+}
+
+// Rectangles are drawn from the middle of the white patch, tinted.
+void
+VideoDriver::QueueRect(const SDL_Rect &Dest, const SDL_Color &Color)
+{
+#if VIDEO_BATCHING
+  SDL_FPoint Points[4];
+  SDL_FPoint TexturePoints[4];
+
+  Points[0].x = Dest.x;
+  Points[0].y = Dest.y;
+  Points[1].x = Dest.x + Dest.w;
+  Points[1].y = Dest.y;
+  Points[2].x = Dest.x + Dest.w;
+  Points[2].y = Dest.y + Dest.h;
+  Points[3].x = Dest.x;
+  Points[3].y = Dest.y + Dest.h;
+
+  for(int I = 0; I < 4; I++) {
+    TexturePoints[I].x = WhiteRect.x + WHITE_SIZE / 2.0f;
+    TexturePoints[I].y = WhiteRect.y + WHITE_SIZE / 2.0f;
+  }
+
+  AddQuad(Atlas, Points, TexturePoints, Color);
+#else
+  SDL_SetRenderDrawColor(MainRenderer, Color.r, Color.g, Color.b, Color.a);
+  SDL_RenderFillRect(MainRenderer, &Dest);
+#endif // VIDEO_BATCHING
+}
+
+void
+VideoDriver::QueueSprite(SDL_Texture *Texture, const SDL_Rect &Src, const SDL_Rect &Dest)
+{
+#if VIDEO_BATCHING
+  const SDL_Color White = { 0xFF, 0xFF, 0xFF, 0xFF };
+  SDL_FPoint Points[4];
+  SDL_FPoint TexturePoints[4];
+
+  Points[0].x = Dest.x;
+  Points[0].y = Dest.y;
+  Points[1].x = Dest.x + Dest.w;
+  Points[1].y = Dest.y;
+  Points[2].x = Dest.x + Dest.w;
+  Points[2].y = Dest.y + Dest.h;
+  Points[3].x = Dest.x;
+  Points[3].y = Dest.y + Dest.h;
+
+  TexturePoints[0].x = Src.x;
+  TexturePoints[0].y = Src.y;
+  TexturePoints[1].x = Src.x + Src.w;
+  TexturePoints[1].y = Src.y;
+  TexturePoints[2].x = Src.x + Src.w;
+  TexturePoints[2].y = Src.y + Src.h;
+  TexturePoints[3].x = Src.x;
+  TexturePoints[3].y = Src.y + Src.h;
+
+  AddQuad(Texture, Points, TexturePoints, White);
+#else
+  SDL_RenderCopy(MainRenderer, Texture, &Src, &Dest);
+#endif // VIDEO_BATCHING
+}
+
 // Private Functions
 static SDL_Surface *
 LoadSurfaceFromPath(const char *ApplicationPath, const char *SurfaceName)
@@ -443,3 +789,39 @@ LoadTextureFromPath(SDL_Renderer *Renderer,
 
   return Texture;
 }
+
+// Places the rectangles in rows, tallest first, and gives the size of the
+// atlas that holds them.
+static void
+PackAtlas(const int NumRects, SDL_Rect *Rects, int &Width, int &Height)
+{
+  std::vector<int> Order(NumRects);
+  int RowX = 0, RowY = 0, RowHeight = 0;
+
+  for(int I = 0; I < NumRects; I++) { Order[I] = I; }
+
+  std::sort(Order.begin(), Order.end(),
+            [Rects](const int A, const int B) { return Rects[A].h > Rects[B].h; });
+
+  Width = 0;
+  Height = 0;
+
+  for(int I = 0; I < NumRects; I++) {
+    SDL_Rect &Rect = Rects[Order[I]];
+
+    if(RowX > 0 && RowX + Rect.w + ATLAS_PADDING * 2 > ATLAS_MAX_WIDTH) {
+      RowX = 0;
+      RowY += RowHeight;
+      RowHeight = 0;
+    }
+
+    Rect.x = RowX + ATLAS_PADDING;
+    Rect.y = RowY + ATLAS_PADDING;
+
+    RowX += Rect.w + ATLAS_PADDING * 2;
+    RowHeight = std::max(RowHeight, Rect.h + ATLAS_PADDING * 2);
+
+    Width = std::max(Width, RowX);
+    Height = std::max(Height, RowY + RowHeight);
+  }
+}
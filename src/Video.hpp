@@ -22,34 +22,84 @@
 #define _VIDEO_HPP_
 
 #include <SDL2/SDL_render.h>
+#include <SDL2/SDL_version.h>
 
 class VideoDriver;
 
 #define NUM_TEXTURES 14
 
+// Draw calls are collected and sent with SDL_RenderGeometry, which older
+// versions of SDL do not have.  Without it every call is drawn at once.
+#define VIDEO_BATCHING SDL_VERSION_ATLEAST(2, 0, 18)
+
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <SDL2/SDL_video.h>
 
 #include "Tile.hpp"
 
+// The tiles, cursor and font are packed into one atlas texture when the
+// driver starts, along with a white patch that rectangles and lines are
+// drawn with.  Drawing adds quads to a batch, which is sent to SDL when a
+// different texture is drawn, the render target changes or the frame ends.
+//
+// The quads of each string drawn are kept, keyed by the string and scale,
+// so text that stays the same from frame to frame is only laid out once.
 class VideoDriver {
 private:
+  struct TextRun {
+    std::vector<SDL_Vertex> Vertices; // Drawn at 0, 0
+    unsigned long LastUsed;
+  };
+
   SDL_Window *MainWindow;
   SDL_Renderer *MainRenderer;
-  SDL_Texture *Textures[NUM_TEXTURES];
-  SDL_Texture *Cursor;
-  SDL_Texture *Fonts;
+  SDL_Texture *Atlas;
+  SDL_Rect TileRects[NUM_TEXTURES];
+  SDL_Rect CursorRect;
+  SDL_Rect FontsRect;
+  SDL_Rect WhiteRect;
   int WindowWidth, WindowHeight;
 
+  SDL_Texture *BatchTexture;
+  int BatchTextureWidth, BatchTextureHeight;
+#if VIDEO_BATCHING
+  std::vector<SDL_Vertex> BatchVertices;
+  std::vector<int> BatchIndices;
+
+  std::unordered_map<std::string, TextRun> TextRuns;
+  std::string TextKey;
+  unsigned long Frame;
+#endif // VIDEO_BATCHING
+
+#if VIDEO_BATCHING
+  void AddQuad(SDL_Texture *Texture,
+               const SDL_FPoint *Points,
+               const SDL_FPoint *TexturePoints, const SDL_Color &Color);
+  void ChangeBatchTexture(SDL_Texture *Texture);
+#endif // VIDEO_BATCHING
   void DrawChar(const char Ch, const int X, const int Y, const double Scale);
-  bool LoadCursor(const char *ApplicationPath);
-  bool LoadFonts(const char *ApplicationPath);
+  void Flush(void);
+  bool LoadAtlas(const char *ApplicationPath);
   bool LoadIcon(const char *ApplicationPath);
-  bool LoadTextures(const char *ApplicationPath);
+#if VIDEO_BATCHING
+  const TextRun &GetTextRun(const char *String, const double Scale);
+#endif // VIDEO_BATCHING
+  void QueueLine(const int StartX,
+                 const int StartY,
+                 const int EndX,
+                 const int EndY, const SDL_Color &Color);
+  void QueueRect(const SDL_Rect &Dest, const SDL_Color &Color);
+  void QueueSprite(SDL_Texture *Texture, const SDL_Rect &Src, const SDL_Rect &Dest);
 public:
   ~VideoDriver(void);
   VideoDriver(void) { }
   bool ChangeFullscreenMode(const bool Fullscreen);
+  void ChangeRenderTarget(SDL_Texture *Target);
   void Clear(void);
+  void ClearTransparent(void);
+  SDL_Texture *CreateTargetTexture(const int Width, const int Height);
   void DrawBox(const int Width,
                const int Height,
                const int X,
@@ -20,8 +20,10 @@
 
 #include "World.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 #include "Config.hpp"
@@ -31,85 +33,143 @@
 #define SQUARE_SIDE_EAST  2
 #define SQUARE_SIDE_SOUTH 3
 
+#define BASE_GRID_CELL_SIZE 16
+#define MAX_BASE_LAYOUTS 16 // Base layouts tried before giving up on a world
+
+// Poisson-disk placement of the bases
+#define BASE_PLACE_CELL_SIZE 8     // Tiles along each side of a placement grid cell
+#define BASE_MIN_SPACING_SQUARED 5 // Bases are more than 2 tiles apart
+#define BASE_PLACE_CANDIDATES 16   // Tries around a base before it is left out
+#define BASE_SEED_TRIES 256        // Tries to find land for a region's first base
+#define BASE_LAND_SAMPLES 64       // Tiles looked at to guess the land of a region
+
+static unsigned int GetChunkSeed(const unsigned int Seed, const int ChunkX, const int ChunkY);
+static bool IsBaseEnemy(const Base *TargetBase, const void *Arg);
+static bool IsBaseUnowned(const Base *TargetBase, const void *Arg);
+
+World::World(void)
+{
+  SizeX = 0;
+  SizeY = 0;
+  Tiles = nullptr;
+  NumBases = 0;
+  Bases = nullptr;
+  NumRegions = 1;
+  GridSizeX = 0;
+  GridSizeY = 0;
+  GridCells = nullptr;
+  GridBases = nullptr;
+  Neighbours = nullptr;
+}
+
 World::~World(void)
 {
   delete[] Tiles;
   delete[] Bases;
-  delete[] BaseArray;
+  delete[] GridCells;
+  delete[] GridBases;
+  delete[] Neighbours;
 }
 
+// Checks that a world of these settings can be built: big enough for a
+// region per player and with room for the bases, and with at least three
+// bases per region so every base can have two neighbours in it.
 bool
-World::Create(const int SizeX,
-              const int SizeY, const int NumBases, std::minstd_rand &Rand)
+World::CheckSettings(const WorldSettings &Settings)
 {
-  this->SizeX = SizeX;
-  this->SizeY = SizeY;
-  this->NumBases = NumBases;
+  const int64_t Area = (int64_t) Settings.SizeX * Settings.SizeY;
 
-  if(!GenTerrain(Rand)) { return false; }
-  if(!GenBases(Rand)) {
-    delete[] Tiles;
+  if(Settings.SizeX < 32 || Settings.SizeX > 65536)                { return false; }
+  if(Settings.SizeY < 32 || Settings.SizeY > 65536)                { return false; }
+  if(Area > (1 << 28))                                             { return false; }
+  if(Settings.NumPlayers < 1 || Settings.NumPlayers > MAX_PLAYERS) { return false; }
+  if(Settings.NumBases < 3 * Settings.NumPlayers)                  { return false; }
+  if(Settings.NumBases > (1 << 24))                                { return false; }
+  if(Settings.NumBases * 32LL > Area)                              { return false; }
 
-    return false;
-  }
+  return true;
+}
 
-  this->BaseArraySize = 0;
-  this->BaseArray = new Base *[NumBases];
-  if(this->BaseArray == nullptr) {
-    delete[] Tiles;
-    delete[] Bases;
+bool
+World::Create(const WorldSettings &Settings, std::minstd_rand &Rand, ThreadPool *Pool)
+{
+  if(!CheckSettings(Settings)) { return false; }
+  if(!CreateTerrain(Settings.SizeX, Settings.SizeY, (unsigned int) Rand(), Pool)) { return false; }
 
-    return false;
+  this->NumBases = Settings.NumBases;
+  this->NumRegions = Settings.NumPlayers;
+
+  // The destructor frees whatever was built if this fails part way.
+  if(!Table.Create(NumBases))  { return false; }
+  if(!Supply.Create(NumBases)) { return false; }
+
+  // A layout only fails when a region runs out of land for its bases.
+  for(int I = 1; !GenBases(Rand); I++) {
+    if(I == MAX_BASE_LAYOUTS) { return false; }
   }
 
-  while(!CheckBaseGen()) { GenBases(Rand); }
+  if(!BuildBaseGrid())       { return false; }
+  if(!BuildNeighbourLists()) { return false; }
 
   return true;
 }
 
-void
-World::Draw(VideoDriver *Video,
-            const int OffsetX, const int OffsetY, const bool DrawGrid)
+// Sets up a world of water and blank bases, to be filled in from a saved
+// game with UnpackTiles() and RestoreBase() and then FinishRestore().
+bool
+World::CreateEmpty(const int SizeX, const int SizeY, const int NumBases)
 {
-  for(int Y = 0; Y < SizeY; Y++) {
-    for(int X = 0; X < SizeX; X++) {
-      TileType Type = GetTile(X, Y)->GetType();
+  this->SizeX = SizeX;
+  this->SizeY = SizeY;
+  this->NumBases = NumBases;
+  this->NumRegions = 1;
+  this->Tiles = nullptr;
+  this->Bases = nullptr;
+  this->GridCells = nullptr;
+  this->GridBases = nullptr;
+  this->Neighbours = nullptr;
 
-      Video->DrawTile(X, Y, OffsetX, OffsetY, Type);
-      if(DrawGrid) {
-        Video->DrawTile(X, Y, OffsetX, OffsetY, TileType::BlackHighlight);
-      }
-    }
-  }
+  if(!Table.Create(NumBases))  { return false; }
+  if(!Supply.Create(NumBases)) { return false; }
 
-  for(int I = 0; I < NumBases; I++) {
-    Base *TargetBase = &Bases[I];
-    int X, Y;
+  Tiles = new uint8_t[(size_t) SizeX * SizeY];
+  Bases = new Base[NumBases];
 
-    TargetBase->GetLoc(X, Y);
-    Video->DrawTile(X, Y, OffsetX, OffsetY, TileType::Base);
+  memset(Tiles, (int) TileType::Water, (size_t) SizeX * SizeY);
+
+  for(int I = 0; I < NumBases; I++) {
+    Bases[I].Create(0, 0, I + 1, 1, 0, &Table, &Supply, I);
   }
+
+  return true;
 }
 
-void
-World::GetNearByBases(const Base *SourceBase, const int MaxDistance)
+// Generates only the terrain of a world with no bases, e.g. to time the
+// generator.  The terrain only depends on Seed, not on Pool.
+bool
+World::CreateTerrain(const int SizeX,
+                     const int SizeY, const unsigned int Seed, ThreadPool *Pool)
 {
-  BaseArraySize = 0;
-
-  for(int I = 0; I < NumBases; I++) { BaseArray[I] = nullptr; }
-
-  for(int I = 0; I < NumBases; I++) {
-    Base *TargetBase = &Bases[I];
+  this->SizeX = SizeX;
+  this->SizeY = SizeY;
+  this->NumBases = 0;
+  this->NumRegions = 1;
+  this->Tiles = nullptr;
+  this->Bases = nullptr;
+  this->GridCells = nullptr;
+  this->GridBases = nullptr;
+  this->Neighbours = nullptr;
+
+  return GenTerrain(Seed, Pool);
+}
 
-    if(SourceBase->GetID() != TargetBase->GetID()) {
-      int Distance;
+bool
+World::FinishRestore(void)
+{
+  if(!BuildBaseGrid())       { return false; }
+  if(!BuildNeighbourLists()) { return false; }
 
-      Distance = SourceBase->GetDistanceToBase(TargetBase);
-      if(Distance <= MaxDistance) {
-        BaseArray[BaseArraySize++] = TargetBase;
-      }
-    }
-  }
+  return true;
 }
 
 Base *
@@ -123,8 +183,14 @@ World::GetBase(const int BaseNum)
 Base *
 World::GetBaseByLoc(const int X, const int Y)
 {
-  for(int I = 0; I < NumBases; I++) {
-    Base *TargetBase = &Bases[I];
+  int Cell;
+
+  if(X < 0 || X >= SizeX) { return nullptr; }
+  if(Y < 0 || Y >= SizeY) { return nullptr; }
+
+  Cell = ((Y / BASE_GRID_CELL_SIZE) * GridSizeX) + (X / BASE_GRID_CELL_SIZE);
+  for(int I = GridCells[Cell]; I < GridCells[Cell + 1]; I++) {
+    Base *TargetBase = GridBases[I];
     int LocX, LocY;
 
     TargetBase->GetLoc(LocX, LocY);
@@ -134,12 +200,110 @@ World::GetBaseByLoc(const int X, const int Y)
   return nullptr;
 }
 
+// Every base with MinX <= X <= MaxX and MinY <= Y <= MaxY, in no
+// particular order.
+void
+World::GetBasesInArea(const int MinX,
+                      const int MinY,
+                      const int MaxX,
+                      const int MaxY, std::vector<Base *> &AreaBases) const
+{
+  int MinCellX, MinCellY, MaxCellX, MaxCellY;
+
+  AreaBases.clear();
+
+  if(MaxX < 0 || MaxY < 0 || MinX >= SizeX || MinY >= SizeY) { return; }
+
+  MinCellX = std::max(MinX, 0) / BASE_GRID_CELL_SIZE;
+  MinCellY = std::max(MinY, 0) / BASE_GRID_CELL_SIZE;
+  MaxCellX = std::min(MaxX, SizeX - 1) / BASE_GRID_CELL_SIZE;
+  MaxCellY = std::min(MaxY, SizeY - 1) / BASE_GRID_CELL_SIZE;
+
+  for(int CellY = MinCellY; CellY <= MaxCellY; CellY++) {
+    for(int CellX = MinCellX; CellX <= MaxCellX; CellX++) {
+      const int Cell = (CellY * GridSizeX) + CellX;
+
+      for(int I = GridCells[Cell]; I < GridCells[Cell + 1]; I++) {
+        Base *TargetBase = GridBases[I];
+        int LocX, LocY;
+
+        TargetBase->GetLoc(LocX, LocY);
+        if(LocX >= MinX && LocX <= MaxX && LocY >= MinY && LocY <= MaxY) {
+          AreaBases.push_back(TargetBase);
+        }
+      }
+    }
+  }
+}
+
+void
+World::GetNearByBases(const Base *SourceBase,
+                      const int MaxDistance,
+                      std::vector<Base *> &NearByBases) const
+{
+  const BaseNeighbour *SourceNeighbours;
+  int NumNeighbours;
+
+  if(Neighbours == nullptr || MaxDistance > MAX_BASE_DISTANCE) {
+    GetGridBases(SourceBase, MaxDistance, NearByBases);
+
+    return;
+  }
+
+  NearByBases.clear();
+
+  SourceNeighbours = SourceBase->GetNeighbours(NumNeighbours);
+  for(int I = 0; I < NumNeighbours; I++) {
+    if(SourceNeighbours[I].Distance > MaxDistance) { break; }
+
+    NearByBases.push_back(SourceNeighbours[I].NeighbourBase);
+  }
+}
+
+Base *
+World::GetNearestEnemyBase(const int X,
+                           const int Y, const Player *TargetPlayer) const
+{
+  return FindNearestBase(X, Y, -1, IsBaseEnemy, TargetPlayer);
+}
+
 Base *
-World::GetBaseFromArray(const int BaseNum)
+World::GetNearestUnownedBase(const Base *SourceBase, const int MaxDistance) const
+{
+  int X, Y;
+
+  // The neighbour list is already in the order FindNearestBase() uses.
+  if(Neighbours != nullptr && MaxDistance <= MAX_BASE_DISTANCE) {
+    const BaseNeighbour *SourceNeighbours;
+    int NumNeighbours;
+
+    SourceNeighbours = SourceBase->GetNeighbours(NumNeighbours);
+    for(int I = 0; I < NumNeighbours; I++) {
+      if(SourceNeighbours[I].Distance > MaxDistance) { break; }
+
+      if(SourceNeighbours[I].NeighbourBase->GetOwner() == nullptr) {
+        return SourceNeighbours[I].NeighbourBase;
+      }
+    }
+
+    return nullptr;
+  }
+
+  SourceBase->GetLoc(X, Y);
+
+  return FindNearestBase(X, Y, MaxDistance, IsBaseUnowned, SourceBase);
+}
+
+// The bases of a region are numbered one after another, and the first
+// regions take one more base each when they do not share out evenly.
+void
+World::GetRegionBases(const int Region, int &FirstBase, int &NumRegionBases) const
 {
-  if(BaseNum < 0 || BaseNum >= BaseArraySize) { return nullptr; }
+  const int Share = NumBases / NumRegions;
+  const int Remainder = NumBases % NumRegions;
 
-  return BaseArray[BaseNum];
+  FirstBase = (Region * Share) + std::min(Region, Remainder);
+  NumRegionBases = Share + ((Region < Remainder) ? 1 : 0);
 }
 
 void
@@ -149,117 +313,253 @@ World::GetSize(int &X, int &Y)
   Y = SizeY;
 }
 
-Tile *
-World::GetTile(const int X, const int Y)
+// Everything off the map counts as water.
+TileType
+World::GetTileType(const int X, const int Y) const
 {
-  if(X < 0 || X >= SizeX) { return nullptr; }
-  if(Y < 0 || Y >= SizeY) { return nullptr; }
+  if(X < 0 || X >= SizeX) { return TileType::Water; }
+  if(Y < 0 || Y >= SizeY) { return TileType::Water; }
 
-  return &Tiles[(Y * SizeX) + X];
+  return GetTileTypeFast(X, Y);
 }
 
 bool
 World::IsBaseBeingAttacked(const Base *SourceBase) const
 {
-  for(int I = 0; I < NumBases; I++) {
-    const Base *AttackingBase = Bases[I].GetAttackingBase();
+  return (SourceBase->GetIncomingAttacks() > 0);
+}
 
-    if(AttackingBase != nullptr) {
-      if(AttackingBase->GetID() == SourceBase->GetID()) {
-        return true;
-      }
-    }
+// Two tiles to a byte, the first in the low four bits.
+void
+World::PackTiles(uint8_t *Buffer) const
+{
+  const int NumTiles = SizeX * SizeY;
+
+  for(int I = 0; I < NumTiles; I += 2) {
+    uint8_t Byte = Tiles[I];
+
+    if(I + 1 < NumTiles) { Byte |= (uint8_t) (Tiles[I + 1] << 4); }
+
+    Buffer[I / 2] = Byte;
   }
+}
 
-  return false;
+void
+World::RestoreBase(const int BaseNum,
+                   const int LocX,
+                   const int LocY,
+                   const BaseID ID, const int Size, const int DefenceValue)
+{
+  Bases[BaseNum].Create(LocX, LocY, ID, Size, DefenceValue, &Table, &Supply, BaseNum);
+}
+
+bool
+World::UnpackTiles(const uint8_t *Buffer)
+{
+  const int NumTiles = SizeX * SizeY;
+
+  for(int I = 0; I < NumTiles; I++) {
+    const int Type = (I & 1) ? Buffer[I / 2] >> 4 : Buffer[I / 2] & 0x0F;
+
+    if(Type > (int) TileType::Water) { return false; }
+
+    Tiles[I] = (uint8_t) Type;
+  }
+
+  return true;
 }
 
 // Private Functions of World
 bool
-World::CheckBaseDistance(const int X, const int Y, const int NumBasesBuilt) const
+World::BuildBaseGrid(void)
 {
-  for(int I = 0; I < NumBasesBuilt; I++) {
-    int BaseLocX, BaseLocY;
-    double Distance;
-    int LocX, LocY;
+  int *Cursor;
 
-    Bases[I].GetLoc(BaseLocX, BaseLocY);
-    LocX = BaseLocX - X;
-    LocY = BaseLocY - Y;
+  delete[] GridCells;
+  delete[] GridBases;
 
-    LocX *= LocX;
-    LocY *= LocY;
+  GridSizeX = (SizeX + BASE_GRID_CELL_SIZE - 1) / BASE_GRID_CELL_SIZE;
+  GridSizeY = (SizeY + BASE_GRID_CELL_SIZE - 1) / BASE_GRID_CELL_SIZE;
 
-    Distance = ceil(sqrt(LocX + LocY));
-    // Check if the base is too close to another base.
-    if(Distance <= 2.0) { return true; }
+  GridCells = new int[(GridSizeX * GridSizeY) + 1];
+  GridBases = new Base *[NumBases];
+  Cursor = new int[GridSizeX * GridSizeY];
+  if(GridCells == nullptr || GridBases == nullptr || Cursor == nullptr) {
+    return false;
   }
 
-  return false;
+  // Count the bases of every cell, then turn the counts into offsets.
+  for(int I = 0; I <= GridSizeX * GridSizeY; I++) { GridCells[I] = 0; }
+  for(int I = 0; I < NumBases; I++) {
+    int X, Y;
+
+    Bases[I].GetLoc(X, Y);
+    GridCells[((Y / BASE_GRID_CELL_SIZE) * GridSizeX) + (X / BASE_GRID_CELL_SIZE) + 1]++;
+  }
+
+  for(int I = 0; I < GridSizeX * GridSizeY; I++) {
+    GridCells[I + 1] += GridCells[I];
+    Cursor[I] = GridCells[I];
+  }
+
+  for(int I = 0; I < NumBases; I++) {
+    int X, Y;
+
+    Bases[I].GetLoc(X, Y);
+    GridBases[Cursor[((Y / BASE_GRID_CELL_SIZE) * GridSizeX) + (X / BASE_GRID_CELL_SIZE)]++] = &Bases[I];
+  }
+
+  delete[] Cursor;
+
+  return true;
 }
 
 bool
-World::CheckBaseGen(void)
+World::BuildNeighbourLists(void)
 {
+  std::vector<BaseNeighbour> NeighbourList;
+  std::vector<int> NeighbourStart;
+  std::vector<Base *> NearByBases;
+
   for(int I = 0; I < NumBases; I++) {
-    const Base *TargetBase = &Bases[I];
+    Base *SourceBase = &Bases[I];
+    const size_t First = NeighbourList.size();
+    int SourceX, SourceY;
+
+    NeighbourStart.push_back(First);
+
+    SourceBase->GetLoc(SourceX, SourceY);
+    GetGridBases(SourceBase, MAX_BASE_DISTANCE, NearByBases);
+    for(size_t J = 0; J < NearByBases.size(); J++) {
+      BaseNeighbour Neighbour;
+
+      Neighbour.NeighbourBase = NearByBases[J];
+      Neighbour.Distance = SourceBase->GetDistanceToBase(NearByBases[J]);
+      Neighbour.NeighbourIndex = NearByBases[J]->GetIndex();
+      NeighbourList.push_back(Neighbour);
+    }
 
-    GetNearByBases(TargetBase, 24);
-    if(BaseArraySize < 2) { return false; }
+    // Closest first by exact distance, then by ID, same as FindNearestBase().
+    std::sort(NeighbourList.begin() + First, NeighbourList.end(),
+              [SourceX, SourceY](const BaseNeighbour &A, const BaseNeighbour &B) {
+                int AX, AY, BX, BY;
+
+                A.NeighbourBase->GetLoc(AX, AY);
+                B.NeighbourBase->GetLoc(BX, BY);
+                AX -= SourceX; AY -= SourceY;
+                BX -= SourceX; BY -= SourceY;
+                if((AX * AX) + (AY * AY) != (BX * BX) + (BY * BY)) {
+                  return (AX * AX) + (AY * AY) < (BX * BX) + (BY * BY);
+                }
+
+                return A.NeighbourBase->GetID() < B.NeighbourBase->GetID();
+              });
+  }
+
+  NeighbourStart.push_back(NeighbourList.size());
+
+  delete[] Neighbours;
+  Neighbours = new BaseNeighbour[NeighbourList.size() + 1];
+  if(Neighbours == nullptr) { return false; }
+
+  for(size_t I = 0; I < NeighbourList.size(); I++) { Neighbours[I] = NeighbourList[I]; }
+  for(int I = 0; I < NumBases; I++) {
+    Bases[I].ChangeNeighbours(&Neighbours[NeighbourStart[I]],
+                              NeighbourStart[I + 1] - NeighbourStart[I]);
   }
 
   return true;
 }
 
+// Checks that a base can go at X, Y: no other base within the spacing,
+// and NeedNeighbours bases of its region, from FirstBase on, close
+// enough to reach it.
 bool
-World::CheckBaseLoc(const int X, const int Y, const int NumBasesBuilt) const
+World::CheckBasePlace(const int X,
+                      const int Y,
+                      const int SpacingSquared,
+                      const int FirstBase,
+                      const int NeedNeighbours,
+                      const std::vector<int> &PlaceCells,
+                      const std::vector<int> &PlaceNext) const
 {
-  for(int I = 0; I < NumBasesBuilt; I++) {
-    int BaseLocX, BaseLocY;
+  const int PlaceSizeX = (SizeX + BASE_PLACE_CELL_SIZE - 1) / BASE_PLACE_CELL_SIZE;
+  const int Spacing = (int) ceil(sqrt((double) SpacingSquared));
+  int MinCellX, MinCellY, MaxCellX, MaxCellY;
+  int NumNeighbours = 0;
+
+  MinCellX = std::max(X - Spacing, 0) / BASE_PLACE_CELL_SIZE;
+  MinCellY = std::max(Y - Spacing, 0) / BASE_PLACE_CELL_SIZE;
+  MaxCellX = std::min(X + Spacing, SizeX - 1) / BASE_PLACE_CELL_SIZE;
+  MaxCellY = std::min(Y + Spacing, SizeY - 1) / BASE_PLACE_CELL_SIZE;
+
+  for(int CellY = MinCellY; CellY <= MaxCellY; CellY++) {
+    for(int CellX = MinCellX; CellX <= MaxCellX; CellX++) {
+      for(int I = PlaceCells[(CellY * PlaceSizeX) + CellX]; I >= 0; I = PlaceNext[I]) {
+        int LocX, LocY;
+
+        Bases[I].GetLoc(LocX, LocY);
+        LocX -= X;
+        LocY -= Y;
+        if((LocX * LocX) + (LocY * LocY) < SpacingSquared) { return false; }
+      }
+    }
+  }
+
+  if(NeedNeighbours == 0) { return true; }
 
-    Bases[I].GetLoc(BaseLocX, BaseLocY);
-    if(X == BaseLocX && Y == BaseLocY) { return true; }
+  MinCellX = std::max(X - MAX_BASE_DISTANCE, 0) / BASE_PLACE_CELL_SIZE;
+  MinCellY = std::max(Y - MAX_BASE_DISTANCE, 0) / BASE_PLACE_CELL_SIZE;
+  MaxCellX = std::min(X + MAX_BASE_DISTANCE, SizeX - 1) / BASE_PLACE_CELL_SIZE;
+  MaxCellY = std::min(Y + MAX_BASE_DISTANCE, SizeY - 1) / BASE_PLACE_CELL_SIZE;
+
+  for(int CellY = MinCellY; CellY <= MaxCellY; CellY++) {
+    for(int CellX = MinCellX; CellX <= MaxCellX; CellX++) {
+      // A cell lists its newest base first, so the region's bases come first.
+      for(int I = PlaceCells[(CellY * PlaceSizeX) + CellX]; I >= FirstBase; I = PlaceNext[I]) {
+        int LocX, LocY;
+
+        Bases[I].GetLoc(LocX, LocY);
+        LocX -= X;
+        LocY -= Y;
+        if((LocX * LocX) + (LocY * LocY) <= MAX_BASE_DISTANCE * MAX_BASE_DISTANCE) {
+          if(++NumNeighbours == NeedNeighbours) { return true; }
+        }
+      }
+    }
   }
 
   return false;
 }
 
-bool
+void
 World::DiamondSquare(const int X, const int Y, std::minstd_rand &Rand)
 {
-  TileType SeedTile;
-
   // Initial Seeds
-  if(GetTile(X, Y)->GetType() == TileType::Water) {
-    SeedTile = TileProbablity(Rand() % 1024);
-    GetTile(X, Y)->ChangeType(SeedTile);
+  if(GetTileTypeFast(X, Y) == TileType::Water) {
+    SetTileTypeFast(X, Y, TileProbablity(Rand() % 1024));
   }
 
-  if(GetTile(X, Y + 2)->GetType() == TileType::Water) {
-    SeedTile = TileProbablity(Rand() % 1024);
-    GetTile(X, Y)->ChangeType(SeedTile);
+  if(GetTileTypeFast(X, Y + 2) == TileType::Water) {
+    SetTileTypeFast(X, Y, TileProbablity(Rand() % 1024));
   }
 
-  if(GetTile(X + 2, Y)->GetType() == TileType::Water) {
-    SeedTile = TileProbablity(Rand() % 1024);
-    GetTile(X, Y)->ChangeType(SeedTile);
+  if(GetTileTypeFast(X + 2, Y) == TileType::Water) {
+    SetTileTypeFast(X, Y, TileProbablity(Rand() % 1024));
   }
 
-  if(GetTile(X + 2, Y + 2)->GetType() == TileType::Water) {
-    SeedTile = TileProbablity(Rand() % 1024);
-    GetTile(X, Y)->ChangeType(SeedTile);
+  if(GetTileTypeFast(X + 2, Y + 2) == TileType::Water) {
+    SetTileTypeFast(X, Y, TileProbablity(Rand() % 1024));
   }
 
-  if(!DiamondStep(X + 1, Y + 1, Rand))                   { return false; }
-  if(!SquareStep(X, Y + 1, SQUARE_SIDE_EAST, Rand))      { return false; }
-  if(!SquareStep(X + 1, Y, SQUARE_SIDE_NORTH, Rand))     { return false; }
-  if(!SquareStep(X + 2, Y + 1, SQUARE_SIDE_WEST, Rand))  { return false; }
-  if(!SquareStep(X + 1, Y + 2, SQUARE_SIDE_SOUTH, Rand)) { return false; }
-
-  return true;
+  DiamondStep(X + 1, Y + 1, Rand);
+  SquareStep(X, Y + 1, SQUARE_SIDE_EAST, Rand);
+  SquareStep(X + 1, Y, SQUARE_SIDE_NORTH, Rand);
+  SquareStep(X + 2, Y + 1, SQUARE_SIDE_WEST, Rand);
+  SquareStep(X + 1, Y + 2, SQUARE_SIDE_SOUTH, Rand);
 }
 
-bool
+void
 World::DiamondStep(const int X, const int Y, std::minstd_rand &Rand)
 {
   double Weight;
@@ -267,10 +567,10 @@ World::DiamondStep(const int X, const int Y, std::minstd_rand &Rand)
   int Height;
 
   Weight = 0.0;
-  Weight += GetTile(X - 1, Y - 1)->GetHeightValue();
-  Weight += GetTile(X - 1, Y + 1)->GetHeightValue();
-  Weight += GetTile(X + 1, Y - 1)->GetHeightValue();
-  Weight += GetTile(X + 1, Y + 1)->GetHeightValue();
+  Weight += GetTileHeightFast(X - 1, Y - 1);
+  Weight += GetTileHeightFast(X - 1, Y + 1);
+  Weight += GetTileHeightFast(X + 1, Y - 1);
+  Weight += GetTileHeightFast(X + 1, Y + 1);
 
   Height = (Weight / 4.0) + ((Rand() % 1000) / 500.0);
   Type = GetTileTypeFromHeight(Height);
@@ -278,94 +578,331 @@ World::DiamondStep(const int X, const int Y, std::minstd_rand &Rand)
     if(Rand() % WORLDGEN_CHANCE_FOR_FOREST_TILE ==  0) { Type = TileType::Forest; }
   }
 
-  GetTile(X, Y)->ChangeType(Type);
+  SetTileTypeFast(X, Y, Type);
+}
 
-  return true;
+Base *
+World::FindNearestBase(const int X,
+                       const int Y,
+                       const int MaxDistance,
+                       bool (*Filter)(const Base *, const void *),
+                       const void *Arg) const
+{
+  Base *ClosestBase = nullptr;
+  int ClosestDistance = 0;
+  int CellX, CellY;
+  int MaxRing;
+
+  CellX = std::min(std::max(X, 0), SizeX - 1) / BASE_GRID_CELL_SIZE;
+  CellY = std::min(std::max(Y, 0), SizeY - 1) / BASE_GRID_CELL_SIZE;
+
+  MaxRing = std::max(GridSizeX, GridSizeY);
+  if(MaxDistance >= 0) {
+    MaxRing = std::min(MaxRing, (MaxDistance / BASE_GRID_CELL_SIZE) + 1);
+  }
+
+  // Search rings of cells around (X, Y).  Everything in ring N is at
+  // least (N - 1) cells away, so stop once that is past the best hit.
+  for(int Ring = 0; Ring <= MaxRing; Ring++) {
+    const int Reach = (Ring - 1) * BASE_GRID_CELL_SIZE;
+
+    if(ClosestBase != nullptr && Reach > 0 &&
+       Reach * Reach > ClosestDistance) {
+      break;
+    }
+
+    for(int RingY = CellY - Ring; RingY <= CellY + Ring; RingY++) {
+      const bool EdgeRow = (RingY == CellY - Ring || RingY == CellY + Ring);
+
+      if(RingY < 0 || RingY >= GridSizeY) { continue; }
+
+      for(int RingX = CellX - Ring; RingX <= CellX + Ring;
+          RingX += (EdgeRow || Ring == 0) ? 1 : (Ring * 2)) {
+        int Cell;
+
+        if(RingX < 0 || RingX >= GridSizeX) { continue; }
+
+        Cell = (RingY * GridSizeX) + RingX;
+        for(int I = GridCells[Cell]; I < GridCells[Cell + 1]; I++) {
+          Base *TargetBase = GridBases[I];
+          int LocX, LocY;
+          int Distance;
+
+          if(!Filter(TargetBase, Arg)) { continue; }
+
+          TargetBase->GetLoc(LocX, LocY);
+          LocX -= X;
+          LocY -= Y;
+          Distance = (LocX * LocX) + (LocY * LocY);
+          if(MaxDistance >= 0 && Distance > MaxDistance * MaxDistance) {
+            continue;
+          }
+
+          // Ties go to the lowest ID so the result does not depend on
+          // the order the cells are visited in.
+          if(ClosestBase == nullptr || Distance < ClosestDistance ||
+             (Distance == ClosestDistance && TargetBase->GetID() < ClosestBase->GetID())) {
+            ClosestBase = TargetBase;
+            ClosestDistance = Distance;
+          }
+        }
+      }
+    }
+  }
+
+  return ClosestBase;
 }
 
 bool
 World::GenBases(std::minstd_rand &Rand)
 {
-  Tile *TargetTile;
+  std::vector<int> PlaceCells;
+  std::vector<int> PlaceNext(NumBases, -1);
   int NumBasesBuilt = 0;
-  int BaseIDNum = 1;
 
+  delete[] Bases;
   Bases = new Base[NumBases];
   if(Bases == nullptr) { return false; }
 
-  for(int X = 0; X < 2; X++) {
-    for(int Y = 0; Y < 2; Y++) {
-      for(int J = 0; J < (NumBases / 4); ) {
-        int LocX, LocY;
+  PlaceCells.assign((size_t) ((SizeX + BASE_PLACE_CELL_SIZE - 1) / BASE_PLACE_CELL_SIZE) *
+                    ((SizeY + BASE_PLACE_CELL_SIZE - 1) / BASE_PLACE_CELL_SIZE), -1);
+
+  for(int Region = 0; Region < NumRegions; Region++) {
+    if(!GenRegionBases(Region, NumBasesBuilt, PlaceCells, PlaceNext, Rand)) { return false; }
+  }
 
-        LocX = (X * (SizeX / 2)) + (Rand() % (SizeX / 2));
-        LocY = (Y * (SizeY / 2)) + (Rand() % (SizeY / 2));
-        if(LocX > SizeX || LocY > SizeY) { abort(); }
+  return true;
+}
 
-        TargetTile = GetTile(LocX, LocY);
-        if(TargetTile->GetType() == TileType::Water ||
-           CheckBaseDistance(LocX, LocY, NumBasesBuilt) == true ||
-           CheckBaseLoc(LocX, LocY, NumBasesBuilt) == true) {
-          continue;
-        }
+// Places the bases of a region as blue noise (Bridson's Poisson-disk
+// sampling): every new base is tried at a random spot within reach of a
+// base already placed, and must be the spacing away from
+// every base and within reach of two bases of its region.  The spacing
+// starts from the land of the region, so the bases spread over it, and
+// shrinks whenever the bases run out of room.  Every round of tries
+// either places a base or drops one from the list to grow from, and the
+// spacing only shrinks a few times, so this is bounded.
+bool
+World::GenRegionBases(const int Region,
+                      int &NumBasesBuilt,
+                      std::vector<int> &PlaceCells,
+                      std::vector<int> &PlaceNext, std::minstd_rand &Rand)
+{
+  int MinX, MinY, MaxX, MaxY;
+  int FirstBase, NumRegionBases;
+  std::vector<int> Active;
+  int SpacingSquared;
+  int NumLand = 0;
+
+  GetRegion(Region, MinX, MinY, MaxX, MaxY);
+  GetRegionBases(Region, FirstBase, NumRegionBases);
+
+  const int Width = MaxX - MinX;
+  const int Height = MaxY - MinY;
 
-        Bases[NumBasesBuilt++].Create(LocX, LocY, BaseIDNum, (Rand() % 9) + 1, TargetTile->GetDefenseValue());
-        J++;
-        BaseIDNum++;
+  for(int I = 0; I < BASE_LAND_SAMPLES; I++) {
+    const int X = MinX + (Rand() % Width);
+    const int Y = MinY + (Rand() % Height);
+
+    if(GetTileTypeFast(X, Y) != TileType::Water) { NumLand++; }
+  }
+
+  // About half as many bases as Poisson-disk sampling fits on the land.
+  SpacingSquared = (int) (((double) std::max(NumLand, 1) * Width * Height) /
+                          ((double) BASE_LAND_SAMPLES * 2.0 * NumRegionBases));
+  SpacingSquared = std::min(SpacingSquared, (MAX_BASE_DISTANCE * MAX_BASE_DISTANCE) / 4);
+  SpacingSquared = std::max(SpacingSquared, BASE_MIN_SPACING_SQUARED);
+
+  while(NumBasesBuilt < FirstBase + NumRegionBases) {
+    int X = 0, Y = 0;
+    bool Found = false;
+
+    if(NumBasesBuilt == FirstBase) {
+      // The first base of the region goes on any land that is free.
+      for(int I = 0; I < BASE_SEED_TRIES && !Found; I++) {
+        X = MinX + (Rand() % Width);
+        Y = MinY + (Rand() % Height);
+        Found = GetTileTypeFast(X, Y) != TileType::Water &&
+                CheckBasePlace(X, Y, SpacingSquared, FirstBase, 0, PlaceCells, PlaceNext);
+      }
+
+      if(!Found) { return false; }
+    } else {
+      if(Active.empty()) {
+        // No room left at this spacing, start over from every base with
+        // three quarters of it.
+        if(SpacingSquared == BASE_MIN_SPACING_SQUARED) { return false; }
+
+        SpacingSquared = std::max((SpacingSquared * 9) / 16, BASE_MIN_SPACING_SQUARED);
+        for(int I = FirstBase; I < NumBasesBuilt; I++) { Active.push_back(I); }
+        continue;
+      }
+
+      const int Pick = (int) (Rand() % Active.size());
+      int SourceX, SourceY;
+
+      Bases[Active[Pick]].GetLoc(SourceX, SourceY);
+
+      for(int I = 0; I < BASE_PLACE_CANDIDATES && !Found; I++) {
+        const int OffsetX = (int) (Rand() % ((2 * MAX_BASE_DISTANCE) + 1)) - MAX_BASE_DISTANCE;
+        const int OffsetY = (int) (Rand() % ((2 * MAX_BASE_DISTANCE) + 1)) - MAX_BASE_DISTANCE;
+        const int DistanceSquared = (OffsetX * OffsetX) + (OffsetY * OffsetY);
+
+        X = SourceX + OffsetX;
+        Y = SourceY + OffsetY;
+
+        if(DistanceSquared > MAX_BASE_DISTANCE * MAX_BASE_DISTANCE) { continue; }
+        if(X < MinX || X >= MaxX || Y < MinY || Y >= MaxY) { continue; }
+        if(GetTileTypeFast(X, Y) == TileType::Water)    { continue; }
+
+        Found = CheckBasePlace(X, Y, SpacingSquared, FirstBase,
+                               std::min(NumBasesBuilt - FirstBase, 2), PlaceCells, PlaceNext);
+      }
+
+      if(!Found) {
+        Active[Pick] = Active.back();
+        Active.pop_back();
+        continue;
       }
     }
+
+    const int Cell = ((Y / BASE_PLACE_CELL_SIZE) * ((SizeX + BASE_PLACE_CELL_SIZE - 1) / BASE_PLACE_CELL_SIZE)) +
+                     (X / BASE_PLACE_CELL_SIZE);
+
+    Bases[NumBasesBuilt].Create(X, Y, NumBasesBuilt + 1, (Rand() % 9) + 1,
+                                GetTileDefenseValue(GetTileTypeFast(X, Y)), &Table, &Supply, NumBasesBuilt);
+    PlaceNext[NumBasesBuilt] = PlaceCells[Cell];
+    PlaceCells[Cell] = NumBasesBuilt;
+    Active.push_back(NumBasesBuilt);
+    NumBasesBuilt++;
   }
 
   return true;
 }
 
+// The terrain is stamped chunk by chunk, each chunk with its own random
+// number generator seeded from the world seed and the chunk's place, so
+// a seed gives the same terrain however the chunks are spread over
+// threads.  A stamp stays inside its chunk but reads the tiles around
+// it, so the chunks run in four passes by the parity of their column and
+// row; chunks of one pass never touch each other and run at once on Pool.
 bool
-World::GenTerrain(std::minstd_rand &Rand)
+World::GenTerrain(const unsigned int Seed, ThreadPool *Pool)
 {
-  int X, Y;
+  const int NumChunksX = (SizeX + WORLDGEN_CHUNK_SIZE - 1) / WORLDGEN_CHUNK_SIZE;
+  const int NumChunksY = (SizeY + WORLDGEN_CHUNK_SIZE - 1) / WORLDGEN_CHUNK_SIZE;
+  const size_t NumTiles = (size_t) SizeX * SizeY;
 
-  Tiles = new Tile[SizeX * SizeY];
-  if(Tiles == nullptr) { return false; }
+  Tiles = new uint8_t[NumTiles];
 
   // Initialize all the tiles as water.
-  for(int Y = 0; Y < SizeY; Y++) {
-    for(int X = 0; X < SizeX; X++) {
-      GetTile(X, Y)->Create(TileType::Water, X, Y);
+  memset(Tiles, (int) TileType::Water, NumTiles);
+
+  for(int Pass = 0; Pass < 4; Pass++) {
+    for(int ChunkY = Pass / 2; ChunkY < NumChunksY; ChunkY += 2) {
+      for(int ChunkX = Pass % 2; ChunkX < NumChunksX; ChunkX += 2) {
+        if(Pool == nullptr) {
+          GenTerrainChunk(ChunkX, ChunkY, Seed);
+        } else {
+          Pool->Submit([=](void) { GenTerrainChunk(ChunkX, ChunkY, Seed); });
+        }
+      }
     }
+
+    if(Pool != nullptr) { Pool->Wait(); }
   }
 
-  for(int I = 0; I < (NUMBER_OF_MAPGEN_ITERATIONS / 4); I++) {
-    X = Rand() % (((SizeX / 2) - 3) + 1);
-    Y = Rand() % (((SizeY / 2) - 3) + 1);
+  return true;
+}
 
-    if(!DiamondSquare(X, Y, Rand)) { return false; }
-  }
+void
+World::GenTerrainChunk(const int ChunkX, const int ChunkY, const unsigned int Seed)
+{
+  const int MinX = ChunkX * WORLDGEN_CHUNK_SIZE;
+  const int MinY = ChunkY * WORLDGEN_CHUNK_SIZE;
+  const int Width = std::min(WORLDGEN_CHUNK_SIZE, SizeX - MinX);
+  const int Height = std::min(WORLDGEN_CHUNK_SIZE, SizeY - MinY);
+  std::minstd_rand Rand(GetChunkSeed(Seed, ChunkX, ChunkY));
 
-  for(int I = 0; I < (NUMBER_OF_MAPGEN_ITERATIONS / 4); I++) {
-    X = Rand() % (((SizeX / 2) - 3) + 1);
-    Y = Rand() % (((SizeY / 2) - 3) + 1);
+  // A stamp is 3 by 3 tiles; thinner chunks at the edge stay water.
+  if(Width < 3 || Height < 3) { return; }
 
-    if(!DiamondSquare((SizeX / 2) + X, Y, Rand)) { return false; }
+  for(int I = 0; I < (Width * Height) / WORLDGEN_TILES_PER_STAMP; I++) {
+    const int X = MinX + (int) (Rand() % (unsigned int) (Width - 2));
+    const int Y = MinY + (int) (Rand() % (unsigned int) (Height - 2));
+
+    DiamondSquare(X, Y, Rand);
   }
+}
+
+void
+World::GetGridBases(const Base *SourceBase,
+                    const int MaxDistance,
+                    std::vector<Base *> &NearByBases) const
+{
+  int MinCellX, MinCellY, MaxCellX, MaxCellY;
+  int SourceX, SourceY;
+
+  NearByBases.clear();
 
-  for(int I = 0; I < (NUMBER_OF_MAPGEN_ITERATIONS / 4); I++) {
-    X = Rand() % (((SizeX / 2) - 3) + 1);
-    Y = Rand() % (((SizeY / 2) - 3) + 1);
+  SourceBase->GetLoc(SourceX, SourceY);
+  MinCellX = std::max(SourceX - MaxDistance, 0) / BASE_GRID_CELL_SIZE;
+  MinCellY = std::max(SourceY - MaxDistance, 0) / BASE_GRID_CELL_SIZE;
+  MaxCellX = std::min(SourceX + MaxDistance, SizeX - 1) / BASE_GRID_CELL_SIZE;
+  MaxCellY = std::min(SourceY + MaxDistance, SizeY - 1) / BASE_GRID_CELL_SIZE;
 
-    if(!DiamondSquare(X, (SizeY / 2) + Y, Rand)) { return false; }
+  for(int CellY = MinCellY; CellY <= MaxCellY; CellY++) {
+    for(int CellX = MinCellX; CellX <= MaxCellX; CellX++) {
+      const int Cell = (CellY * GridSizeX) + CellX;
+
+      for(int I = GridCells[Cell]; I < GridCells[Cell + 1]; I++) {
+        Base *TargetBase = GridBases[I];
+        int LocX, LocY;
+
+        if(TargetBase == SourceBase) { continue; }
+
+        // Same test as GetDistanceToBase() <= MaxDistance without the sqrt.
+        TargetBase->GetLoc(LocX, LocY);
+        LocX -= SourceX;
+        LocY -= SourceY;
+        if((LocX * LocX) + (LocY * LocY) <= MaxDistance * MaxDistance) {
+          NearByBases.push_back(TargetBase);
+        }
+      }
+    }
   }
+}
+
+// The regions are laid out in columns, about as many columns as rows,
+// and numbered down each column in turn; four regions are the quarters.
+void
+World::GetRegion(const int Region, int &MinX, int &MinY, int &MaxX, int &MaxY) const
+{
+  const int NumColumns = std::max(1, (int) sqrt((double) NumRegions));
+  int FirstRegion = 0;
 
-  for(int I = 0; I < (NUMBER_OF_MAPGEN_ITERATIONS / 4); I++) {
-    X = Rand() % (((SizeX / 2) - 3) + 1);
-    Y = Rand() % (((SizeY / 2) - 3) + 1);
+  for(int Column = 0; Column < NumColumns; Column++) {
+    const int NumRows = (NumRegions / NumColumns) + ((Column < NumRegions % NumColumns) ? 1 : 0);
 
-    if(!DiamondSquare((SizeX / 2) + X, (SizeY / 2) + Y, Rand)) { return false; }
+    if(Region < FirstRegion + NumRows) {
+      const int Row = Region - FirstRegion;
+
+      MinX = (Column * SizeX) / NumColumns;
+      MaxX = ((Column + 1) * SizeX) / NumColumns;
+      MinY = (Row * SizeY) / NumRows;
+      MaxY = ((Row + 1) * SizeY) / NumRows;
+
+      return;
+    }
+
+    FirstRegion += NumRows;
   }
 
-  return true;
+  /* Should never get here. */
+  abort();
 }
 
-bool
+void
 World::SquareStep(const int X,
                   const int Y, const int Side, std::minstd_rand &Rand)
 {
@@ -379,73 +916,73 @@ World::SquareStep(const int X,
   switch(Side) {
   case SQUARE_SIDE_EAST:
     if(X + 1 < SizeX) {
-      Weight += GetTile(X + 1, Y)->GetHeightValue();
+      Weight += GetTileHeightFast(X + 1, Y);
       Average += 1.0;
     }
     if(X - 1 >= 0) {
-      Weight += GetTile(X - 1, Y)->GetHeightValue();
+      Weight += GetTileHeightFast(X - 1, Y);
       Average += 1.0;
     }
     if(Y - 1 >= 0) {
-      Weight += GetTile(X, Y - 1)->GetHeightValue();
+      Weight += GetTileHeightFast(X, Y - 1);
       Average += 1.0;
     }
     if(Y + 1 < SizeY) {
-      Weight += GetTile(X, Y + 1)->GetHeightValue();
+      Weight += GetTileHeightFast(X, Y + 1);
       Average += 1.0;
     }
     break;
   case SQUARE_SIDE_NORTH:
     if(X - 1 <= 0) {
-      Weight += GetTile(X - 1, Y)->GetHeightValue();
+      Weight += GetTileHeightFast(X - 1, Y);
       Average += 1.0;
     }
     if(X + 1 < SizeX) {
-      Weight += GetTile(X + 1, Y)->GetHeightValue();
+      Weight += GetTileHeightFast(X + 1, Y);
       Average += 1.0;
     }
     if(Y - 1 >= 0) {
-      Weight += GetTile(X, Y - 1)->GetHeightValue();
+      Weight += GetTileHeightFast(X, Y - 1);
       Average += 1.0;
     }
     if(Y + 1 < SizeY) {
-      Weight += GetTile(X, Y + 1)->GetHeightValue();
+      Weight += GetTileHeightFast(X, Y + 1);
       Average += 1.0;
     }
     break;
   case SQUARE_SIDE_WEST:
     if(X - 1 >= 0) {
-      Weight += GetTile(X - 1, Y)->GetHeightValue();
+      Weight += GetTileHeightFast(X - 1, Y);
       Average += 1.0;
     }
     if(X + 1 < SizeX) {
-      Weight += GetTile(X + 1, Y)->GetHeightValue();
+      Weight += GetTileHeightFast(X + 1, Y);
       Average += 1.0;
     }
     if(Y - 1 <= 0) {
-      Weight += GetTile(X, Y - 1)->GetHeightValue();
+      Weight += GetTileHeightFast(X, Y - 1);
       Average += 1.0;
     }
     if(Y + 1 < SizeY) {
-      Weight += GetTile(X, Y + 1)->GetHeightValue();
+      Weight += GetTileHeightFast(X, Y + 1);
       Average += 1.0;
     }
     break;
   case SQUARE_SIDE_SOUTH:
     if(X - 1 >= 0) {
-      Weight += GetTile(X - 1, Y)->GetHeightValue();
+      Weight += GetTileHeightFast(X - 1, Y);
       Average += 1.0;
     }
     if(X + 1 < SizeX) {
-      Weight += GetTile(X + 1, Y)->GetHeightValue();
+      Weight += GetTileHeightFast(X + 1, Y);
       Average += 1.0;
     }
     if(Y - 1 >= 0) {
-      Weight += GetTile(X, Y - 1)->GetHeightValue();
+      Weight += GetTileHeightFast(X, Y - 1);
       Average += 1.0;
     }
     if(Y + 1 < SizeY) {
-      Weight += GetTile(X, Y + 1)->GetHeightValue();
+      Weight += GetTileHeightFast(X, Y + 1);
       Average += 1.0;
     }
     break;
@@ -459,13 +996,11 @@ World::SquareStep(const int X,
     if(Rand() % WORLDGEN_CHANCE_FOR_FOREST_TILE == 0) { Type = TileType::Forest; }
   }
 
-  GetTile(X, Y)->ChangeType(Type);
-
-  return true;
+  SetTileTypeFast(X, Y, Type);
 }
 
 TileType
-World::TileProbablity(const unsigned int Value)
+World::TileProbablity(const unsigned int Value) const
 {
   if(Value < 64)                   { return TileType::Water; }
   if(Value >= 64 && Value < 512)   { return TileType::Grassland; }
@@ -475,3 +1010,36 @@ World::TileProbablity(const unsigned int Value)
   /* Should never get here. */
   abort();
 }
+
+// Helper Functions for World
+static unsigned int
+GetChunkSeed(const unsigned int Seed, const int ChunkX, const int ChunkY)
+{
+  uint64_t Value;
+
+  // SplitMix64 of the seed and the chunk's place.
+  Value = ((uint64_t) Seed << 32) ^ ((uint64_t) (uint32_t) ChunkY << 16) ^ (uint32_t) ChunkX;
+  Value += 0x9E3779B97F4A7C15ULL;
+  Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBULL;
+  Value ^= Value >> 31;
+
+  return (unsigned int) (Value >> 32);
+}
+
+// Filter Functions for World
+static bool
+IsBaseEnemy(const Base *TargetBase, const void *Arg)
+{
+  const Player *TargetPlayer = static_cast<const Player *>(Arg);
+
+  return (TargetBase->GetOwner() != nullptr && TargetBase->GetOwner() != TargetPlayer);
+}
+
+static bool
+IsBaseUnowned(const Base *TargetBase, const void *Arg)
+{
+  const Base *SourceBase = static_cast<const Base *>(Arg);
+
+  return (TargetBase != SourceBase && TargetBase->GetOwner() == nullptr);
+}
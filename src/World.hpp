@@ -22,51 +22,134 @@
 #define _WORLD_HPP_
 
 class World;
+struct WorldSettings;
 
+#include <cstddef>
+#include <cstdint>
 #include <random>
+#include <vector>
 
 #include "Base.hpp"
+#include "BaseTable.hpp"
+#include "Config.hpp"
+#include "SupplyGraph.hpp"
+#include "ThreadPool.hpp"
 #include "Tile.hpp"
-#include "Video.hpp"
+
+// The size of a world and how many players it is shared out between.
+struct WorldSettings {
+  int SizeX;
+  int SizeY;
+  int NumBases;   // At least three per player
+  int NumPlayers; // Up to MAX_PLAYERS
+};
+
+static const WorldSettings DefaultWorldSettings = {
+  WORLD_SIZE_X,
+  WORLD_SIZE_Y,
+  NUMBER_OF_BASES,
+  NUMBER_OF_PLAYERS
+};
 
 class World {
 private:
   int SizeX;
   int SizeY;
-  Tile *Tiles;
+
+  // One TileType a byte, row by row.
+  uint8_t *Tiles;
 
   int NumBases;
   Base *Bases;
+  BaseTable Table;
+  SupplyGraph Supply;
+
+  // The world is cut into one region per player, each with its share of
+  // the bases, so every player starts with room of their own.
+  int NumRegions;
+
+  // Uniform grid over the base locations.  GridCells holds, for every
+  // cell, the offset of its first base in GridBases (one extra entry
+  // at the end), so the bases of a cell are contiguous.
+  int GridSizeX;
+  int GridSizeY;
+  int *GridCells;
+  Base **GridBases;
 
-  int BaseArraySize;
-  Base **BaseArray;
+  // Every base's neighbour list, packed back to back.
+  BaseNeighbour *Neighbours;
 
-  bool CheckBaseDistance(const int X, const int Y, const int NumBasesBuilt) const;
-  bool CheckBaseGen(void);
-  bool CheckBaseLoc(const int X, const int Y, const int NumBasesBuilt) const;
-  bool DiamondSquare(const int X, const int Y, std::minstd_rand &Rand);
-  bool DiamondStep(const int X, const int Y, std::minstd_rand &Rand);
+  bool BuildBaseGrid(void);
+  bool BuildNeighbourLists(void);
+  bool CheckBasePlace(const int X,
+                      const int Y,
+                      const int SpacingSquared,
+                      const int FirstBase,
+                      const int NeedNeighbours,
+                      const std::vector<int> &PlaceCells,
+                      const std::vector<int> &PlaceNext) const;
+  void DiamondSquare(const int X, const int Y, std::minstd_rand &Rand);
+  void DiamondStep(const int X, const int Y, std::minstd_rand &Rand);
+  Base *FindNearestBase(const int X,
+                        const int Y,
+                        const int MaxDistance,
+                        bool (*Filter)(const Base *, const void *),
+                        const void *Arg) const;
   bool GenBases(std::minstd_rand &Rand);
-  bool GenTerrain(std::minstd_rand &Rand);
-  bool SquareStep(const int X,
+  bool GenRegionBases(const int Region,
+                      int &NumBasesBuilt,
+                      std::vector<int> &PlaceCells,
+                      std::vector<int> &PlaceNext, std::minstd_rand &Rand);
+  void GetGridBases(const Base *SourceBase,
+                    const int MaxDistance,
+                    std::vector<Base *> &NearByBases) const;
+  void GetRegion(const int Region, int &MinX, int &MinY, int &MaxX, int &MaxY) const;
+  bool GenTerrain(const unsigned int Seed, ThreadPool *Pool);
+  void GenTerrainChunk(const int ChunkX, const int ChunkY, const unsigned int Seed);
+  int GetTileHeightFast(const int X, const int Y) const { return GetTileHeightValue(GetTileTypeFast(X, Y)); }
+  size_t GetTileIndex(const int X, const int Y) const { return ((size_t) Y * SizeX) + X; }
+  // No bounds checks; X and Y must be on the map.
+  TileType GetTileTypeFast(const int X, const int Y) const { return (TileType) Tiles[GetTileIndex(X, Y)]; }
+  void SetTileTypeFast(const int X,
+                       const int Y, const TileType Type) { Tiles[GetTileIndex(X, Y)] = (uint8_t) Type; }
+  void SquareStep(const int X,
                   const int Y, const int Side, std::minstd_rand &Rand);
-  TileType TileProbablity(const unsigned int Value);
+  TileType TileProbablity(const unsigned int Value) const;
 public:
-  World(void) { }
+  World(void);
   ~World(void);
-  bool Create(const int SizeX,
-              const int SizeY, const int NumBases, std::minstd_rand &Rand);
-  void Draw(VideoDriver *Video,
-            const int OffsetX, const int OffsetY, const bool DrawGrid);
-  int GetBaseArraySize(void) const { return BaseArraySize; }
+  static bool CheckSettings(const WorldSettings &Settings);
+  bool Create(const WorldSettings &Settings, std::minstd_rand &Rand, ThreadPool *Pool);
+  bool CreateEmpty(const int SizeX, const int SizeY, const int NumBases);
+  bool CreateTerrain(const int SizeX,
+                     const int SizeY, const unsigned int Seed, ThreadPool *Pool);
+  bool FinishRestore(void);
   Base *GetBase(const int BaseNum);
   Base *GetBaseByLoc(const int X, const int Y);
-  Base *GetBaseFromArray(const int BaseNum);
-  void GetNearByBases(const Base *SourceBase, const int MaxDistance);
+  void GetBasesInArea(const int MinX,
+                      const int MinY,
+                      const int MaxX,
+                      const int MaxY, std::vector<Base *> &AreaBases) const;
+  BaseTable *GetBaseTable(void) { return &Table; }
+  void GetNearByBases(const Base *SourceBase,
+                      const int MaxDistance,
+                      std::vector<Base *> &NearByBases) const;
+  Base *GetNearestEnemyBase(const int X,
+                            const int Y, const Player *TargetPlayer) const;
+  Base *GetNearestUnownedBase(const Base *SourceBase, const int MaxDistance) const;
   int GetNumBases(void) const { return NumBases; }
+  void GetRegionBases(const int Region, int &FirstBase, int &NumRegionBases) const;
+  size_t GetPackedTilesSize(void) const { return ((size_t) SizeX * SizeY + 1) / 2; }
   void GetSize(int &X, int &Y);
-  Tile *GetTile(const int X, const int Y);
+  SupplyGraph *GetSupplyGraph(void) { return &Supply; }
+  TileType GetTileType(const int X, const int Y) const;
   bool IsBaseBeingAttacked(const Base *SourceBase) const;
+  void PackTiles(uint8_t *Buffer) const;
+  void RestoreBase(const int BaseNum,
+                   const int LocX,
+                   const int LocY,
+                   const BaseID ID, const int Size, const int DefenceValue);
+  bool UnpackTiles(const uint8_t *Buffer);
 };
 
 #endif // _WORLD_HPP_